@@ -0,0 +1,212 @@
+/*
+ * opencog/atoms/execution/AsyncExecutor.cc
+ *
+ * Run queries and evaluations in the background.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <algorithm>
+
+#include <opencog/util/Logger.h>
+#include <opencog/query/BindLinkAPI.h>
+
+#include "AsyncExecutor.h"
+#include "EvaluationLink.h"
+#include "Instantiator.h"
+
+using namespace opencog;
+
+static size_t default_workers(size_t nworkers)
+{
+	if (0 < nworkers) return nworkers;
+	return std::max(2U, std::thread::hardware_concurrency());
+}
+
+AsyncExecutor::AsyncExecutor(size_t nworkers) :
+	_stop(false),
+	_pool(default_workers(nworkers), default_workers(nworkers))
+{
+	_watchdog = std::thread(&AsyncExecutor::watch, this);
+}
+
+AsyncExecutor::~AsyncExecutor()
+{
+	// Cancelling interrupts scheme code, which may need the lock; so
+	// cancel only once it is let go.
+	Running running;
+	{
+		std::lock_guard<std::mutex> lck(_mtx);
+		_stop = true;
+		running = _running;
+	}
+	for (const std::shared_ptr<ExecControl>& ctl : running)
+		ctl->cancel();
+	_wake.notify_all();
+	_watchdog.join();
+
+	// The pool, destroyed next, waits for the executions to unwind.
+}
+
+void AsyncExecutor::watch(void)
+{
+	std::unique_lock<std::mutex> lck(_mtx);
+	while (not _stop)
+	{
+		if (_deadlines.empty())
+		{
+			_wake.wait(lck);
+			continue;
+		}
+
+		auto first = _deadlines.begin();
+		if (ExecControl::Clock::now() < first->first)
+		{
+			_wake.wait_until(lck, first->first);
+			continue;
+		}
+
+		// Executions that are already done have let go of their
+		// controls, by now.
+		std::shared_ptr<ExecControl> ctl = first->second.lock();
+		_deadlines.erase(first);
+		if (not ctl) continue;
+
+		// As in the destructor, don't cancel with the lock held.
+		lck.unlock();
+		ctl->cancel();
+		lck.lock();
+	}
+}
+
+// ==========================================================
+
+template<typename T>
+AsyncResult<T> AsyncExecutor::run(std::function<T(void)> fn,
+                                  Timeout timeout, AsyncCallback<T> done)
+{
+	auto ctl = std::make_shared<ExecControl>(timeout);
+	auto prom = std::make_shared<std::promise<T>>();
+
+	AsyncResult<T> ares;
+	ares.result = prom->get_future();
+	ares.control = ctl;
+
+	{
+		std::lock_guard<std::mutex> lck(_mtx);
+		_running.insert(ctl);
+		if (ctl->has_deadline())
+		{
+			bool first = _deadlines.empty() or
+			             ctl->get_deadline() < _deadlines.begin()->first;
+			_deadlines.emplace(ctl->get_deadline(), ctl);
+			if (first) _wake.notify_all();
+		}
+	}
+
+	_pool.submit([this, fn, ctl, prom, done]()
+	{
+		T result;
+		std::exception_ptr err;
+		{
+			ExecControl::Scope scope(ctl.get());
+			try
+			{
+				ctl->check();
+				result = fn();
+			}
+			catch (...)
+			{
+				err = std::current_exception();
+			}
+		}
+
+		// Interrupted code reports errors of its own; report them
+		// as the cancellation that they were.
+		if (err and ctl->is_cancelled())
+		{
+			try { ctl->check(); }
+			catch (...) { err = std::current_exception(); }
+		}
+
+		{
+			std::lock_guard<std::mutex> lck(_mtx);
+			_running.erase(ctl);
+		}
+
+		if (done)
+		{
+			try
+			{
+				done(result, err);
+			}
+			catch (const std::exception& ex)
+			{
+				logger().warn("AsyncExecutor: callback threw: %s", ex.what());
+			}
+		}
+
+		if (err) prom->set_exception(err);
+		else prom->set_value(result);
+	});
+
+	return ares;
+}
+
+// ==========================================================
+
+AsyncResult<Handle> AsyncExecutor::bindlink(AtomSpace* as, const Handle& h,
+                                            size_t max_results,
+                                            Timeout timeout,
+                                            AsyncCallback<Handle> done)
+{
+	return run<Handle>([as, h, max_results]()
+		{ return opencog::bindlink(as, h, max_results); },
+		timeout, done);
+}
+
+AsyncResult<Handle> AsyncExecutor::satisfying_set(AtomSpace* as,
+                                                  const Handle& h,
+                                                  size_t max_results,
+                                                  Timeout timeout,
+                                                  AsyncCallback<Handle> done)
+{
+	return run<Handle>([as, h, max_results]()
+		{ return opencog::satisfying_set(as, h, max_results); },
+		timeout, done);
+}
+
+AsyncResult<TruthValuePtr> AsyncExecutor::evaluate(AtomSpace* as,
+                                                   const Handle& h,
+                                                   Timeout timeout,
+                                                   AsyncCallback<TruthValuePtr> done)
+{
+	return run<TruthValuePtr>([as, h]()
+		{ return EvaluationLink::do_evaluate(as, h); },
+		timeout, done);
+}
+
+AsyncResult<Handle> AsyncExecutor::execute(AtomSpace* as, const Handle& h,
+                                           Timeout timeout,
+                                           AsyncCallback<Handle> done)
+{
+	return run<Handle>([as, h]()
+		{
+			Instantiator inst(as);
+			return inst.execute(h);
+		},
+		timeout, done);
+}
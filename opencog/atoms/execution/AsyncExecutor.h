@@ -0,0 +1,140 @@
+/*
+ * opencog/atoms/execution/AsyncExecutor.h
+ *
+ * Run queries and evaluations in the background.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_ASYNC_EXECUTOR_H
+#define _OPENCOG_ASYNC_EXECUTOR_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+
+#include <opencog/atomspace/AtomSpace.h>
+#include <opencog/atomutils/ExecControl.h>
+#include <opencog/atoms/execution/EvaluationPool.h>
+
+namespace opencog
+{
+/** \addtogroup grp_atomspace
+ *  @{
+ */
+
+/// The future result of a background execution, and the means to
+/// cancel it.  After a cancel, or a missed deadline, the future holds
+/// a RuntimeException.
+template<typename T>
+struct AsyncResult
+{
+	std::future<T> result;
+	std::shared_ptr<ExecControl> control;
+
+	void cancel(void) { control->cancel(); }
+};
+
+/// Called once the execution finishes, with its result, or with the
+/// exception that ended it.
+template<typename T>
+using AsyncCallback = std::function<void(const T&, std::exception_ptr)>;
+
+/**
+ * Runs bindlink(), satisfying_set(), EvaluationLink::do_evaluate() and
+ * Instantiator::execute() on a fixed number of worker threads, so that
+ * callers need not block on them.  Each call returns at once, with a
+ * future and an ExecControl; the optional callback runs on the worker,
+ * just before the future becomes ready.
+ *
+ * A timeout gives the execution a deadline.  Both deadlines and
+ * cancel() are cooperative: they are checked wherever ExecControl is
+ * polled (see there), and scheme procedures are interrupted, much as
+ * control-C interrupts them at the shell.  Python
+ * code cannot be interrupted; it is stopped only once it returns.
+ *
+ * Destroying the executor cancels all executions not yet finished,
+ * and waits for them to unwind.
+ */
+class AsyncExecutor
+{
+	public:
+		typedef std::chrono::milliseconds Timeout;
+
+	private:
+		typedef std::multimap<ExecControl::Clock::time_point,
+		                      std::weak_ptr<ExecControl>> Deadlines;
+
+		std::mutex _mtx;
+		std::condition_variable _wake;
+		bool _stop;
+
+		// Executions not yet finished, queued or running.
+		typedef std::unordered_set<std::shared_ptr<ExecControl>> Running;
+		Running _running;
+
+		// The watchdog cancels executions as their deadlines pass,
+		// so that scheme code stuck in a loop gets interrupted.
+		Deadlines _deadlines;
+		std::thread _watchdog;
+		void watch(void);
+
+		template<typename T>
+		AsyncResult<T> run(std::function<T(void)>, Timeout,
+		                   AsyncCallback<T>);
+
+		// Declared last, so that it is destroyed, and its workers
+		// joined, before anything they use.
+		EvaluationPool _pool;
+
+	public:
+		/// Zero workers means one per core.
+		AsyncExecutor(size_t nworkers = 0);
+		~AsyncExecutor();
+		AsyncExecutor(const AsyncExecutor&) = delete;
+		AsyncExecutor& operator=(const AsyncExecutor&) = delete;
+
+		AsyncResult<Handle> bindlink(AtomSpace*, const Handle&,
+		                             size_t max_results = SIZE_MAX,
+		                             Timeout = Timeout::zero(),
+		                             AsyncCallback<Handle> = nullptr);
+
+		AsyncResult<Handle> satisfying_set(AtomSpace*, const Handle&,
+		                                   size_t max_results = SIZE_MAX,
+		                                   Timeout = Timeout::zero(),
+		                                   AsyncCallback<Handle> = nullptr);
+
+		AsyncResult<TruthValuePtr> evaluate(AtomSpace*, const Handle&,
+		                                    Timeout = Timeout::zero(),
+		                                    AsyncCallback<TruthValuePtr> = nullptr);
+
+		AsyncResult<Handle> execute(AtomSpace*, const Handle&,
+		                            Timeout = Timeout::zero(),
+		                            AsyncCallback<Handle> = nullptr);
+};
+
+/** @}*/
+} //namespace opencog
+
+#endif // _OPENCOG_ASYNC_EXECUTOR_H
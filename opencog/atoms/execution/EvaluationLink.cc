@@ -20,7 +20,7 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
-#include <thread>
+#include <functional>
 
 #include <opencog/atoms/base/atom_types.h>
 #include <opencog/truthvalue/SimpleTruthValue.h>
@@ -33,12 +33,14 @@
 #include <opencog/atoms/reduct/FoldLink.h>
 
 #include <opencog/atomspace/AtomSpace.h>
+#include <opencog/atomutils/ExecControl.h>
 #include <opencog/cython/PythonEval.h>
 #include <opencog/guile/SchemeEval.h>
 #include <opencog/query/BindLinkAPI.h>
 
 #include "Force.h"
 #include "EvaluationLink.h"
+#include "EvaluationPool.h"
 
 using namespace opencog;
 
@@ -189,18 +191,22 @@ static bool is_tail_rec(const Handle& thish, const Handle& tail)
 	return false;
 }
 
+/// Evaluate in a scratch atomspace of the worker's own, since the
+/// caller's scratch space may be gone before the worker gets to run.
 static void thread_eval(AtomSpace* as,
-                        const Handle& evelnk, AtomSpace* scratch,
-                        bool silent)
+                        const Handle& evelnk, bool silent)
 {
-	EvaluationLink::do_eval_scratch(as, evelnk, scratch, silent);
-}
-
-static void thread_eval_tv(AtomSpace* as,
-                     const Handle& evelnk, AtomSpace* scratch,
-                     bool silent, TruthValuePtr* tv)
-{
-	*tv = EvaluationLink::do_eval_scratch(as, evelnk, scratch, silent);
+	AtomSpace* scratch = AtomSpace::grab_transient(as);
+	try
+	{
+		EvaluationLink::do_eval_scratch(as, evelnk, scratch, silent);
+	}
+	catch (...)
+	{
+		AtomSpace::release_transient(scratch);
+		throw;
+	}
+	AtomSpace::release_transient(scratch);
 }
 
 /// do_evaluate -- evaluate any Node or Link types that can meaningfully
@@ -239,6 +245,9 @@ TruthValuePtr EvaluationLink::do_eval_scratch(AtomSpace* as,
                      const Handle& evelnk, AtomSpace* scratch,
                      bool silent)
 {
+	// Tail-recursive sequences loop through here, and may run forever.
+	ExecControl::check_current();
+
 	Type t = evelnk->getType();
 	if (EVALUATION_LINK == t)
 	{
@@ -347,16 +356,18 @@ TruthValuePtr EvaluationLink::do_eval_scratch(AtomSpace* as,
 		size_t arity = oset.size();
 		std::vector<TruthValuePtr> tvp(arity);
 
-		// Create a collection of joinable threads.
-		std::vector<std::thread> thread_set;
+		// Run them on the shared pool; this thread helps out, and
+		// returns when all are done.
+		std::vector<EvaluationPool::Task> tasks;
 		for (size_t i=0; i< arity; i++)
 		{
-			thread_set.push_back(std::thread(&thread_eval_tv,
-				as, oset[i], scratch, silent, &tvp[i]));
+			const Handle& h = oset[i];
+			TruthValuePtr* tv = &tvp[i];
+			tasks.push_back([as, h, scratch, silent, tv]() {
+				*tv = EvaluationLink::do_eval_scratch(as, h, scratch, silent);
+			});
 		}
-
-		// Wait for it all to come together.
-		for (std::thread& t : thread_set) t.join();
+		EvaluationPool::instance().run_all(tasks);
 
 		// Return the logical-AND of the returned truth values
 		for (const TruthValuePtr& tv: tvp)
@@ -368,12 +379,10 @@ TruthValuePtr EvaluationLink::do_eval_scratch(AtomSpace* as,
 	}
 	else if (PARALLEL_LINK == t)
 	{
-		// Create and detach threads; return immediately.
+		// Hand them to the shared pool; return immediately.
+		EvaluationPool& pool = EvaluationPool::instance();
 		for (const Handle& h : evelnk->getOutgoingSet())
-		{
-			std::thread thr(&thread_eval, as, h, scratch, silent);
-			thr.detach();
-		}
+			pool.submit(std::bind(&thread_eval, as, h, silent));
 		return TruthValue::TRUE_TV();
 	}
 	else if (TRUE_LINK == t or FALSE_LINK == t)
@@ -543,6 +552,12 @@ TruthValuePtr EvaluationLink::do_evaluate(AtomSpace* as,
 	// to do lazy execution correctly. Right now, forcing is the policy.
 	// We could add "scm-lazy:" and "py-lazy:" URI's for user-defined
 	// functions smart enough to do lazy evaluation.
+	//
+	// A vectorised predicate, called for just one argument list, is
+	// a batch of one; the batch evaluator forces the arguments itself.
+	if (is_vectorised(pn))
+		return do_evaluate_batch(as, pn, HandleSeq(1, cargs))[0];
+
 	Handle args = force_execute(as, cargs);
 
 	// Get the schema name.
@@ -610,3 +625,85 @@ TruthValuePtr EvaluationLink::do_evaluate(AtomSpace* as,
 	     "Cannot evaluate unknown GroundedPredicateNode: %s",
 	      schema.c_str());
 }
+
+/// is_vectorised -- true if the schema is a GroundedPredicateNode
+/// whose name declares it to be vectorised.
+///
+/// A vectorised predicate "py-vec:foo" or "scm-vec:foo" takes the same
+/// number of arguments as the ordinary "py:foo" would, except that each
+/// argument is a list, holding that argument for every one of a batch
+/// of evaluations. It must return a list of TV's, one per evaluation.
+/// This allows the cost of crossing into python or scheme to be paid
+/// once per batch, instead of once per evaluation.
+///
+bool EvaluationLink::is_vectorised(const Handle& pn)
+{
+	if (GROUNDED_PREDICATE_NODE != pn->getType()) return false;
+	const std::string& schema = pn->getName();
+	return 0 == schema.compare(0, 8, "scm-vec:", 8) or
+	       0 == schema.compare(0, 7, "py-vec:", 7);
+}
+
+/// do_evaluate_batch -- evaluate a vectorised GroundedPredicateNode
+///
+/// Expects "pn" to be a vectorised GroundedPredicateNode, and each
+/// of "arglists" to be the (unexecuted) arguments of one evaluation:
+/// ListLinks of the same arity, or single atoms, each of which is one
+/// argument. The user function is called once, for all of them.
+///
+std::vector<TruthValuePtr>
+EvaluationLink::do_evaluate_batch(AtomSpace* as,
+                                  const Handle& pn,
+                                  const HandleSeq& arglists)
+{
+	// Throw a silent exception, as do_evaluate() does; the caller may
+	// then evaluate the argument lists one at a time.
+	if (not is_vectorised(pn))
+		throw NotEvaluatableException();
+
+	if (arglists.empty()) return std::vector<TruthValuePtr>();
+
+	// As in do_evaluate(), the arguments are forced.
+	HandleSeq args;
+	args.reserve(arglists.size());
+	for (const Handle& cargs : arglists)
+		args.emplace_back(force_execute(as, cargs));
+
+	std::vector<TruthValuePtr> tvs;
+	const std::string& schema = pn->getName();
+	if (0 == schema.compare(0, 8, "scm-vec:", 8))
+	{
+#ifdef HAVE_GUILE
+		// Be friendly, and strip leading white-space, if any.
+		size_t pos = 8;
+		while (' ' == schema[pos]) pos++;
+
+		SchemeEval* applier = SchemeEval::get_evaluator(as);
+		tvs = applier->apply_tv_batch(schema.substr(pos), args);
+#else
+		throw RuntimeException(TRACE_INFO,
+			 "Cannot evaluate scheme GroundedPredicateNode!");
+#endif /* HAVE_GUILE */
+	}
+	else
+	{
+#ifdef HAVE_CYTHON
+		// Be friendly, and strip leading white-space, if any.
+		size_t pos = 7;
+		while (' ' == schema[pos]) pos++;
+
+		PythonEval &applier = PythonEval::instance();
+		tvs = applier.apply_tv_batch(as, schema.substr(pos), args);
+#else
+		throw RuntimeException(TRACE_INFO,
+			 "Cannot evaluate python GroundedPredicateNode!");
+#endif /* HAVE_CYTHON */
+	}
+
+	if (tvs.size() != args.size())
+		throw RuntimeException(TRACE_INFO,
+		     "Vectorised predicate %s returned %zu TruthValues for %zu "
+		     "argument lists!", schema.c_str(), tvs.size(), args.size());
+
+	return tvs;
+}
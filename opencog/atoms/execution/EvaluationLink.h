@@ -60,6 +60,15 @@ public:
 	                                 const HandleSeq& schema_and_args);
 	static TruthValuePtr do_evaluate(AtomSpace*,
 	                                const Handle& schema, const Handle& args);
+
+	// Evaluate a vectorised GroundedPredicateNode ("py-vec:" or
+	// "scm-vec:") on many argument lists, with a single call into
+	// the user function.  Returns one TV per argument list.  Throws
+	// NotEvaluatableException if the schema is not vectorised.
+	static bool is_vectorised(const Handle& schema);
+	static std::vector<TruthValuePtr> do_evaluate_batch(AtomSpace*,
+	                                const Handle& schema,
+	                                const HandleSeq& arglists);
 };
 
 typedef std::shared_ptr<EvaluationLink> EvaluationLinkPtr;
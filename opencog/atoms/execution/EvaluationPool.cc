@@ -0,0 +1,247 @@
+/*
+ * opencog/atoms/execution/EvaluationPool.cc
+ *
+ * Shared worker threads for ParallelLink and JoinLink.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <algorithm>
+#include <exception>
+
+#include <opencog/util/Logger.h>
+#include <opencog/atomutils/ExecControl.h>
+
+#include "EvaluationPool.h"
+
+using namespace opencog;
+
+// Which worker of the pool the current thread is, if any.
+static thread_local EvaluationPool* tl_pool = nullptr;
+static thread_local size_t tl_worker = 0;
+
+// ==========================================================
+
+EvaluationPool::EvaluationPool(size_t nworkers, size_t max_workers) :
+	_max_workers(max_workers),
+	_workers(new Worker[max_workers]),
+	_nworkers(0),
+	_pending(0),
+	_idle(0),
+	_next(0),
+	_stop(false)
+{
+	for (size_t i = 0; i < nworkers; i++)
+		add_worker();
+}
+
+EvaluationPool::~EvaluationPool()
+{
+	{
+		std::lock_guard<std::mutex> lck(_sleep_mtx);
+		_stop = true;
+	}
+	_wake.notify_all();
+
+	// No more workers may be added, once we start joining.
+	size_t n;
+	{
+		std::lock_guard<std::mutex> lck(_grow_mtx);
+		n = _nworkers;
+		_max_workers = n;
+	}
+	for (size_t i = 0; i < n; i++)
+		_workers[i].thr.join();
+}
+
+EvaluationPool& EvaluationPool::instance(void)
+{
+	// Never destroyed: ParallelLink members may still be running, and
+	// may never finish, when the program exits.
+	static size_t ncores = std::max(2U, std::thread::hardware_concurrency());
+	static EvaluationPool* pool = new EvaluationPool(ncores, 8 * ncores);
+	return *pool;
+}
+
+void EvaluationPool::add_worker(void)
+{
+	std::lock_guard<std::mutex> lck(_grow_mtx);
+	size_t n = _nworkers;
+	if (_max_workers <= n) return;
+
+	// The worker must be runnable before it can be stolen from,
+	// so the count is bumped only after the thread exists.
+	_workers[n].thr = std::thread(&EvaluationPool::worker_loop, this, n);
+	_nworkers = n + 1;
+}
+
+// ==========================================================
+
+void EvaluationPool::push(Task&& task)
+{
+	// Workers push onto their own queue; everyone else spreads
+	// their tasks around.
+	size_t nw = _nworkers;
+	size_t w = (this == tl_pool) ? tl_worker : _next++ % nw;
+	{
+		std::lock_guard<std::mutex> lck(_workers[w].mtx);
+		_workers[w].tasks.emplace_back(std::move(task));
+	}
+	_pending++;
+
+	// If no one is free to run it, add a worker, if we can.
+	if (0 == _idle and nw < _max_workers)
+		add_worker();
+
+	{
+		std::lock_guard<std::mutex> lck(_sleep_mtx);
+	}
+	_wake.notify_one();
+}
+
+/// Take a task: the newest of our own, else the oldest of another's.
+bool EvaluationPool::try_pop(Task& task)
+{
+	size_t nw = _nworkers;
+	size_t self = (this == tl_pool) ? tl_worker : 0;
+
+	if (this == tl_pool)
+	{
+		Worker& w = _workers[self];
+		std::lock_guard<std::mutex> lck(w.mtx);
+		if (not w.tasks.empty())
+		{
+			task = std::move(w.tasks.back());
+			w.tasks.pop_back();
+			_pending--;
+			return true;
+		}
+	}
+
+	for (size_t i = 1; i <= nw; i++)
+	{
+		Worker& w = _workers[(self + i) % nw];
+		std::lock_guard<std::mutex> lck(w.mtx);
+		if (not w.tasks.empty())
+		{
+			task = std::move(w.tasks.front());
+			w.tasks.pop_front();
+			_pending--;
+			return true;
+		}
+	}
+	return false;
+}
+
+void EvaluationPool::worker_loop(size_t self)
+{
+	tl_pool = this;
+	tl_worker = self;
+
+	while (true)
+	{
+		Task task;
+		if (try_pop(task))
+		{
+			task();
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lck(_sleep_mtx);
+		if (_stop) return;
+		if (0 < _pending) continue;
+		_idle++;
+		_wake.wait(lck);
+		_idle--;
+	}
+}
+
+// ==========================================================
+
+void EvaluationPool::submit(Task task)
+{
+	push([task]()
+	{
+		try
+		{
+			task();
+		}
+		catch (const std::exception& ex)
+		{
+			logger().warn("EvaluationPool: task threw: %s", ex.what());
+		}
+		catch (...)
+		{
+			logger().warn("EvaluationPool: task threw unknown exception");
+		}
+	});
+}
+
+void EvaluationPool::run_all(const std::vector<Task>& tasks)
+{
+	if (tasks.empty()) return;
+
+	// Each task is run exactly once, by whoever claims it first:
+	// a worker, or this thread.
+	struct Group
+	{
+		std::vector<std::atomic_bool> claimed;
+		std::atomic<size_t> left;
+		std::mutex mtx;
+		std::condition_variable done;
+		std::exception_ptr error;
+		Group(size_t n) : claimed(n), left(n) {}
+	};
+	auto grp = std::make_shared<Group>(tasks.size());
+	for (std::atomic_bool& c : grp->claimed) c = false;
+
+	// A cancel of the caller's execution stops the tasks, too.
+	ExecControl* ctl = ExecControl::current();
+
+	auto run = [grp, &tasks, ctl](size_t i)
+	{
+		if (grp->claimed[i].exchange(true)) return;
+		ExecControl::Scope scope(ctl);
+		try
+		{
+			tasks[i]();
+		}
+		catch (...)
+		{
+			std::lock_guard<std::mutex> lck(grp->mtx);
+			if (not grp->error) grp->error = std::current_exception();
+		}
+		if (0 == --grp->left)
+		{
+			std::lock_guard<std::mutex> lck(grp->mtx);
+			grp->done.notify_all();
+		}
+	};
+
+	// The tasks vector outlives every claimed run, because this
+	// thread does not return until all have finished; unclaimed
+	// wrappers left in the queues return without touching it.
+	for (size_t i = 1; i < tasks.size(); i++)
+		push([run, i]() { run(i); });
+
+	for (size_t i = 0; i < tasks.size(); i++)
+		run(i);
+
+	std::unique_lock<std::mutex> lck(grp->mtx);
+	grp->done.wait(lck, [&grp]() { return 0 == grp->left; });
+
+	if (grp->error) std::rethrow_exception(grp->error);
+}
@@ -0,0 +1,121 @@
+/*
+ * opencog/atoms/execution/EvaluationPool.h
+ *
+ * Shared worker threads for ParallelLink and JoinLink.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_EVALUATION_POOL_H
+#define _OPENCOG_EVALUATION_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <opencog/atomspace/AtomSpace.h>
+
+namespace opencog
+{
+/** \addtogroup grp_atomspace
+ *  @{
+ */
+
+/**
+ * A process-wide, work-stealing pool of worker threads, used to
+ * evaluate the members of ParallelLink and JoinLink.
+ *
+ * Starting a thread is expensive, and, for guile and python, so is
+ * the per-thread setup of the interpreter.  Workers are long-lived,
+ * and so each one sets up its evaluators only once; a worker's scheme
+ * evaluator, for example, is found again by SchemeEval::get_evaluator
+ * every time it runs a task.
+ *
+ * Each worker has its own task queue; it runs its own tasks newest
+ * first, and steals the oldest tasks from other workers when it has
+ * none.  The pool starts with one worker per core, and grows, up to
+ * a fixed limit, only when all workers are busy.  Since ParallelLink
+ * members may run forever, a worker may be lost to a task for good;
+ * the limit bounds how many such tasks run at once, and the rest wait
+ * in the queues.
+ *
+ * Tasks submitted with run_all() are also run by the calling thread,
+ * whenever no worker has started them yet, so that waiting for them
+ * can never deadlock, even when called from a worker.
+ */
+class EvaluationPool
+{
+	public:
+		typedef std::function<void(void)> Task;
+
+	private:
+		struct Worker
+		{
+			std::mutex mtx;
+			std::deque<Task> tasks;
+			std::thread thr;
+		};
+
+		std::atomic<size_t> _max_workers;
+		std::unique_ptr<Worker[]> _workers;
+		std::atomic<size_t> _nworkers;
+		std::mutex _grow_mtx;
+
+		std::atomic<size_t> _pending;
+		std::atomic<size_t> _idle;
+		std::atomic<size_t> _next;
+		std::mutex _sleep_mtx;
+		std::condition_variable _wake;
+		bool _stop;
+
+		void add_worker(void);
+		void worker_loop(size_t);
+		void push(Task&&);
+		bool try_pop(Task&);
+
+	public:
+		/// Start `nworkers` workers, and allow up to `max_workers`.
+		/// Most users want the shared instance(), instead.
+		EvaluationPool(size_t nworkers, size_t max_workers);
+		~EvaluationPool();
+		EvaluationPool(const EvaluationPool&) = delete;
+		EvaluationPool& operator=(const EvaluationPool&) = delete;
+
+		/// The shared pool.
+		static EvaluationPool& instance(void);
+
+		/// Run the task on some worker; return immediately.
+		/// Exceptions thrown by the task are logged, and dropped.
+		void submit(Task);
+
+		/// Run all of the tasks, and return when all are done.  The
+		/// first exception thrown by any task is rethrown here.  The
+		/// tasks run under the caller's ExecControl, if any.
+		void run_all(const std::vector<Task>&);
+
+		/// Number of worker threads currently running.
+		size_t size(void) const { return _nworkers; }
+};
+
+/** @}*/
+} //namespace opencog
+
+#endif // _OPENCOG_EVALUATION_POOL_H
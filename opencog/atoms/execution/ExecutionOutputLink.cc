@@ -23,6 +23,8 @@
 #include <dlfcn.h>
 #include <stdlib.h>
 
+#include <mutex>
+
 #include <opencog/atoms/base/atom_types.h>
 #include <opencog/atomspace/AtomSpace.h>
 #include <opencog/atoms/core/DefineLink.h>
@@ -37,6 +39,7 @@ using namespace opencog;
 class LibraryManager
 {
 private:
+    static std::mutex _mtx;
     static std::unordered_map<std::string, void*> _librarys;
     static std::unordered_map<std::string, void*> _functions;
 public:
@@ -217,11 +220,20 @@ Handle ExecutionOutputLink::do_execute(AtomSpace* as,
 		"Cannot evaluate unknown Schema %s", gsn->toString().c_str());
 }
 
+std::mutex LibraryManager::_mtx;
 std::unordered_map<std::string, void*> LibraryManager::_librarys;
 std::unordered_map<std::string, void*> LibraryManager::_functions;
 
 void* LibraryManager::getFunc(std::string libName,std::string funcName)
 {
+    std::lock_guard<std::mutex> lck(_mtx);
+
+    // Fast path: the function was already resolved.
+    std::string funcID = libName + "\\" + funcName;
+    auto fit = _functions.find(funcID);
+    if (_functions.end() != fit)
+        return fit->second;
+
     void* libHandle;
     if (_librarys.count(libName) == 0) {
         // Try and load the library and function.
@@ -235,20 +247,12 @@ void* LibraryManager::getFunc(std::string libName,std::string funcName)
         libHandle = _librarys[libName];
     }
 
-    std::string funcID = libName + "\\" + funcName;
-
-    void* sym;
-    if (_functions.count(funcID) == 0){
-        sym = dlsym(libHandle, funcName.c_str());
-        if (nullptr == sym)
-            throw RuntimeException(TRACE_INFO,
-                "Cannot find symbol %s in library: %s - %s",
-                funcName.c_str(), libName.c_str(), dlerror());
-        _functions[funcID] = sym;
-    }
-    else {
-        sym = _functions[funcID];
-    }
+    void* sym = dlsym(libHandle, funcName.c_str());
+    if (nullptr == sym)
+        throw RuntimeException(TRACE_INFO,
+            "Cannot find symbol %s in library: %s - %s",
+            funcName.c_str(), libName.c_str(), dlerror());
+    _functions[funcID] = sym;
 
     return sym;
 }
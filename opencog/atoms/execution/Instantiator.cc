@@ -21,6 +21,7 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <opencog/atomutils/ExecControl.h>
 #include <opencog/atoms/core/DefineLink.h>
 #include <opencog/atoms/core/LambdaLink.h>
 // #include <opencog/atoms/core/MapLink.h>
@@ -463,6 +464,10 @@ Handle Instantiator::instantiate(const Handle& expr,
 		throw InvalidParamException(TRACE_INFO,
 			"Asked to ground a null expression");
 
+	// Each grounding of a query is instantiated separately; stop
+	// between them, if the execution has been cancelled.
+	ExecControl::check_current();
+
 	_quotation = Quotation();
 	_avoid_discarding_quotes_level = 0;
 
@@ -25,6 +25,7 @@
 #include <iostream>
 #include <fstream>
 #include <list>
+#include <vector>
 
 #include <stdlib.h>
 
@@ -93,6 +94,49 @@ void AtomSpace::clear_transient()
     _atom_table.clear_transient();
 }
 
+// Cache of empty transient atomspaces, one per thread.  The pattern
+// matcher evaluates in a scratch space for every candidate grounding,
+// so this is on the hot path: a thread-local cache avoids contending
+// on a lock.
+static const size_t MAX_CACHED_TRANSIENTS = 8;
+
+namespace {
+struct TransientCache
+{
+    std::vector<AtomSpace*> spaces;
+    ~TransientCache()
+    {
+        for (AtomSpace* as : spaces) delete as;
+    }
+};
+}
+
+static thread_local TransientCache tl_transients;
+
+AtomSpace* AtomSpace::grab_transient(AtomSpace* parent)
+{
+    std::vector<AtomSpace*>& spaces = tl_transients.spaces;
+    if (spaces.empty())
+        return new AtomSpace(parent, true);
+
+    AtomSpace* scratch = spaces.back();
+    spaces.pop_back();
+    scratch->ready_transient(parent);
+    return scratch;
+}
+
+void AtomSpace::release_transient(AtomSpace* scratch)
+{
+    std::vector<AtomSpace*>& spaces = tl_transients.spaces;
+    if (MAX_CACHED_TRANSIENTS <= spaces.size())
+    {
+        delete scratch;
+        return;
+    }
+    scratch->clear_transient();
+    spaces.push_back(scratch);
+}
+
 AtomSpace& AtomSpace::operator=(const AtomSpace&)
 {
      throw opencog::RuntimeException(TRACE_INFO,
@@ -493,23 +537,56 @@ Handle AtomSpace::fetch_incoming_set(Handle h, bool recursive)
 
     if (nullptr == h) return Handle::UNDEFINED;
 
-    // Get everything from the backing store.
-    HandleSeq iset = _backing_store->getIncomingSet(h);
-    size_t isz = iset.size();
-    for (size_t i=0; i<isz; i++) {
-        Handle hi(iset[i]);
-        if (recursive) {
-            fetch_incoming_set(hi, true);
-        } else {
-            get_atom(hi);
+    // Get everything from the backing store. This is streamed, so that
+    // the incoming set of a hub atom is never all in memory twice.
+    if (not recursive) {
+        _backing_store->foreachIncoming(h, ATOM, true,
+            [this](const Handle& hi) {
+                _atom_table.add(hi, false);
+                return false;
+            });
+        return h;
+    }
+
+    // The recursive fetch is done breadth-first, so that the whole
+    // of each level is obtained with one batched request, instead of
+    // one request per atom. The seen-set stops links that are
+    // reachable along several paths from being fetched repeatedly.
+    UnorderedHandleSet seen;
+    HandleSeq level({h});
+    while (not level.empty()) {
+        HandleSeq iset = _backing_store->getIncomingSets(level);
+        level.clear();
+        for (const Handle& hi : iset) {
+            Handle ha(_atom_table.add(hi, false));
+            if (ha and seen.insert(ha).second)
+                level.emplace_back(ha);
         }
     }
     return h;
 }
 
+Handle AtomSpace::fetch_incoming_by_type(Handle h, Type t, bool subclass,
+                   const std::function<bool(const Handle&)>& cb)
+{
+    if (NULL == _backing_store)
+        throw RuntimeException(TRACE_INFO, "No backing store");
+
+    h = get_atom(h);
+
+    if (nullptr == h) return Handle::UNDEFINED;
+
+    _backing_store->foreachIncoming(h, t, subclass,
+        [&](const Handle& hi) {
+            Handle ha(_atom_table.add(hi, false));
+            return cb and cb(ha);
+        });
+    return h;
+}
+
 bool AtomSpace::remove_atom(Handle h, bool recursive)
 {
-    if (_backing_store) {
+    if (_backing_store and not _backing_store->handlesRemoval()) {
         // Atom deletion has not been implemented in the backing store
         // This is a major to-do item.
 // Under construction ....
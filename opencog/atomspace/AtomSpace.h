@@ -26,6 +26,7 @@
 #define _OPENCOG_ATOMSPACE_H
 
 #include <algorithm>
+#include <functional>
 #include <list>
 #include <set>
 #include <vector>
@@ -98,6 +99,17 @@ public:
     void ready_transient(AtomSpace* parent);
     void clear_transient();
 
+    /**
+     * Get an empty transient atomspace, with `parent` as its parent,
+     * for use as a scratch space; hand it back with release_transient()
+     * when done.  Creating an atomspace is expensive, so released ones
+     * are kept around for re-use.  The cache is per-thread, and so
+     * needs no locking; a space may be released on a different thread
+     * than it was grabbed on.
+     */
+    static AtomSpace* grab_transient(AtomSpace* parent);
+    static void release_transient(AtomSpace*);
+
     /// Get the environment that this atomspace was created in.
     AtomSpace* get_environ() const {
         AtomTable* env = _atom_table.get_environ();
@@ -261,10 +273,24 @@ public:
      * If the flag is true, then the load is done recursively.
      * This method queries the backing store to obtain all atoms that
      * contain this one in their outgoing sets. All of these atoms are
-     * then loaded into this atomtable/atomspace.
+     * then loaded into this atomtable/atomspace.  A recursive load
+     * makes one (batched) backing-store request per level.
      */
     Handle fetch_incoming_set(Handle, bool);
 
+    /**
+     * Use the backing store to load those links in the incoming set
+     * of the atom that are of type t (or, if subclass is set, of any
+     * subtype of t).  The type restriction is applied by the backing
+     * store, and the links are loaded as they arrive, rather than
+     * all at once.  If a callback is given, each link is passed to
+     * it after being added to the atomspace; returning true from the
+     * callback stops the fetch, so that a caller looking through the
+     * incoming set of a hub atom need not load all of it.
+     */
+    Handle fetch_incoming_by_type(Handle, Type, bool subclass = false,
+               const std::function<bool(const Handle&)>& cb = nullptr);
+
     /**
      * Recursively store the atom to the backing store.
      * I.e. if the atom is a link, then store all of the atoms
@@ -27,6 +27,7 @@
 
 #include "AtomTable.h"
 
+#include <algorithm>
 #include <atomic>
 #include <iterator>
 #include <mutex>
@@ -141,32 +142,37 @@ void AtomTable::clear_all_atoms()
         throw opencog::RuntimeException(TRACE_INFO,
                 "AtomTable - clear_all_atoms called on non-transient atom table.");
 
+    // Scratch spaces are cleared after every evaluation, and are
+    // usually empty; don't walk anything, then.
+    if (0 == _size) return;
+
     // Reset the size to zero.
     _size = 0;
     _num_nodes = 0;
     _num_links = 0;
 
     // Clear the by-type size cache.
-    Type total_types = _size_by_type.size();
-    for (Type type = ATOM; type < total_types; type++)
-        _size_by_type[type] = 0;
+    std::fill(_size_by_type.begin(), _size_by_type.end(), 0);
 
-    // Clear the atoms in the set.
+    // If a link is in this table, we need to remove it from the
+    // incoming sets for the atoms in its outgoing set. See note in
+    // the analogous loop in ~AtomTable above.  This is done for the
+    // atoms in this table, too: any of them may be held elsewhere,
+    // and outlive the clear.
     for (auto& pr : _atom_store) {
-        Handle& atom_to_clear = pr.second;
-        atom_to_clear->_atomTable = NULL;
-
-        // If this is a link we need to remove this atom from the incoming
-        // sets for any atoms in this atom's outgoing set. See note in
-        // the analogous loop in ~AtomTable above.
-        if (atom_to_clear->isLink()) {
-            LinkPtr link_to_clear = LinkCast(atom_to_clear);
-            for (AtomPtr atom_in_out_set : atom_to_clear->getOutgoingSet()) {
-                atom_in_out_set->remove_atom(link_to_clear);
-            }
-        }
+        const Handle& atom_to_clear = pr.second;
+        if (not atom_to_clear->isLink()) continue;
+
+        LinkPtr link_to_clear = LinkCast(atom_to_clear);
+        for (const Handle& atom_in_out_set : link_to_clear->getOutgoingSet())
+            atom_in_out_set->remove_atom(link_to_clear);
     }
 
+    // Atoms still referenced from elsewhere no longer belong to
+    // any table.
+    for (auto& pr : _atom_store)
+        pr.second->_atomTable = NULL;
+
     // Clear the atom store. This will delete all the atoms since
     // this will be the last shared_ptr referecence, and set the
     // size of the set to 0.
@@ -24,6 +24,7 @@
 
 #include "BackingStore.h"
 
+#include <opencog/atoms/base/ClassServer.h>
 #include <opencog/atomspace/AtomSpace.h>
 
 using namespace opencog;
@@ -65,6 +66,48 @@ bool BackingStore::ignoreAtom(const Handle& h) const
 	return should_ignore;
 }
 
+bool BackingStore::foreachIncoming(const Handle& h, Type t, bool subclass,
+                 const std::function<bool(const Handle&)>& cb) const
+{
+	for (const Handle& hi : getIncomingSet(h))
+	{
+		Type it = hi->getType();
+		if (it != t and not (subclass and classserver().isA(it, t)))
+			continue;
+		if (cb(hi)) return true;
+	}
+	return false;
+}
+
+HandleSeq BackingStore::getNodes(const HandleSeq& hs) const
+{
+	HandleSeq found;
+	found.reserve(hs.size());
+	for (const Handle& h : hs)
+		found.emplace_back(getNode(h->getType(), h->getName().c_str()));
+	return found;
+}
+
+HandleSeq BackingStore::getLinks(HandleSeq& hs) const
+{
+	HandleSeq found;
+	found.reserve(hs.size());
+	for (Handle& h : hs)
+		found.emplace_back(getLink(h));
+	return found;
+}
+
+HandleSeq BackingStore::getIncomingSets(const HandleSeq& hs) const
+{
+	HandleSeq iset;
+	UnorderedHandleSet seen;
+	for (const Handle& h : hs)
+		for (const Handle& hi : getIncomingSet(h))
+			if (seen.insert(hi).second)
+				iset.emplace_back(hi);
+	return iset;
+}
+
 void BackingStore::registerWith(AtomSpace* atomspace)
 {
 	atomspace->registerBackingStore(this);
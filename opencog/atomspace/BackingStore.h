@@ -24,6 +24,7 @@
 #ifndef _OPENCOG_BACKING_STORE_H
 #define _OPENCOG_BACKING_STORE_H
 
+#include <functional>
 #include <set>
 
 #include <opencog/atoms/base/Atom.h>
@@ -66,6 +67,42 @@ class BackingStore
 		 */
 		virtual HandleSeq getIncomingSet(const Handle&) const = 0;
 
+		/**
+		 * Batched versions of getNode() and getLink(). Return a vector
+		 * of the same length as the argument, holding the stored
+		 * version of each atom, or NULL if it is not in storage.
+		 *
+		 * Storage providers that talk to a server should override
+		 * these, so that many atoms are fetched in one round trip.
+		 * The default implementations just loop over getNode() and
+		 * getLink().
+		 */
+		virtual HandleSeq getNodes(const HandleSeq&) const;
+		virtual HandleSeq getLinks(HandleSeq&) const;
+
+		/**
+		 * Return the union of the incoming sets of all of the
+		 * indicated atoms.  A link that contains several of them
+		 * appears only once.  The default implementation loops over
+		 * getIncomingSet().
+		 */
+		virtual HandleSeq getIncomingSets(const HandleSeq&) const;
+
+		/**
+		 * Call `cb` on each link in the incoming set of the indicated
+		 * atom that is of type `t` (or of a subtype of `t`, if
+		 * `subclass` is set), as the links arrive from storage.  The
+		 * iteration stops as soon as `cb` returns true; the return
+		 * value says whether it did.
+		 *
+		 * Unlike getIncomingSet(), the incoming set of a hub atom is
+		 * never held in memory all at once, and a caller that only
+		 * needs some of it does not pay for the rest.  The default
+		 * implementation filters the result of getIncomingSet().
+		 */
+		virtual bool foreachIncoming(const Handle&, Type t, bool subclass,
+		             const std::function<bool(const Handle&)>& cb) const;
+
 		/**
 		 * Recursively store the atom and anything in it's outgoing set.
 		 * If the atom is already in storage, this will update it's 
@@ -107,6 +144,14 @@ class BackingStore
 		 */
 		virtual bool ignoreAtom(const Handle&) const;
 
+		/**
+		 * Returns true if the backing store records atom removals on
+		 * its own, e.g. by listening to the AtomTable remove signal.
+		 * Atoms can be removed from an AtomSpace only if its backing
+		 * store can do this.
+		 */
+		virtual bool handlesRemoval() const { return false; }
+
 		/**
 		 * The set of ignored atom types.
 		 */
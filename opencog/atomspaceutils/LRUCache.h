@@ -0,0 +1,185 @@
+/*
+ * opencog/atomspaceutils/LRUCache.h
+ *
+ * Bounded, sharded least-recently-used cache.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_LRU_CACHE_H
+#define _OPENCOG_LRU_CACHE_H
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+#include <opencog/util/exceptions.h>
+
+namespace opencog
+{
+
+/**
+ * A thread-safe cache holding at most `capacity` entries.  When full,
+ * inserting a new entry evicts the least-recently used one.
+ *
+ * The cache is split into shards, chosen by key hash, each with its
+ * own lock and its own LRU list; concurrent readers only contend when
+ * they hit the same shard.  Eviction is therefore approximately, not
+ * exactly, LRU over the cache as a whole: each shard holds at most
+ * capacity/shards entries.
+ *
+ * Hit, miss and eviction counts are kept, for tuning cache sizes.
+ */
+template<typename Key, typename Value, typename Hash = std::hash<Key>>
+class LRUCache
+{
+private:
+    typedef std::list<std::pair<Key, Value>> LRUList;
+
+    struct Shard
+    {
+        std::mutex mtx;
+        LRUList lru;   // Most recently used at the front.
+        std::unordered_map<Key, typename LRUList::iterator, Hash> index;
+    };
+
+    size_t _nshards;
+    size_t _shard_capacity;
+    std::unique_ptr<Shard[]> _shards;
+    Hash _hash;
+
+    std::atomic<size_t> _hits;
+    std::atomic<size_t> _misses;
+    std::atomic<size_t> _evictions;
+
+    Shard& shard(const Key& key)
+    {
+        return _shards[_hash(key) % _nshards];
+    }
+
+public:
+    LRUCache(size_t capacity, size_t nshards = 16)
+        : _hits(0), _misses(0), _evictions(0)
+    {
+        if (0 == capacity or 0 == nshards)
+            throw InvalidParamException(TRACE_INFO,
+                "LRUCache capacity and shard count must be positive.");
+
+        // Small caches don't benefit from sharding, and would end up
+        // with shards of size one.
+        _nshards = std::min(nshards, (capacity + 7) / 8);
+        _shard_capacity = (capacity + _nshards - 1) / _nshards;
+        _shards.reset(new Shard[_nshards]);
+    }
+    LRUCache(const LRUCache&) = delete;
+    LRUCache& operator=(const LRUCache&) = delete;
+
+    /// Look up `key`; on a hit, copy its value into `value`, mark the
+    /// entry as most recently used, and return true.
+    bool get(const Key& key, Value& value)
+    {
+        Shard& s = shard(key);
+        std::lock_guard<std::mutex> lck(s.mtx);
+        auto it = s.index.find(key);
+        if (s.index.end() == it)
+        {
+            _misses.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        s.lru.splice(s.lru.begin(), s.lru, it->second);
+        value = it->second->second;
+        _hits.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /// Insert or replace the value for `key`, evicting the least
+    /// recently used entry of the shard if it is full.
+    void put(const Key& key, const Value& value)
+    {
+        Shard& s = shard(key);
+        std::lock_guard<std::mutex> lck(s.mtx);
+        auto it = s.index.find(key);
+        if (s.index.end() != it)
+        {
+            it->second->second = value;
+            s.lru.splice(s.lru.begin(), s.lru, it->second);
+            return;
+        }
+
+        if (s.index.size() >= _shard_capacity)
+        {
+            s.index.erase(s.lru.back().first);
+            s.lru.pop_back();
+            _evictions.fetch_add(1, std::memory_order_relaxed);
+        }
+        s.lru.emplace_front(key, value);
+        s.index.emplace(key, s.lru.begin());
+    }
+
+    /// Remove `key`, if present. Returns true if it was present.
+    bool erase(const Key& key)
+    {
+        Shard& s = shard(key);
+        std::lock_guard<std::mutex> lck(s.mtx);
+        auto it = s.index.find(key);
+        if (s.index.end() == it) return false;
+        s.lru.erase(it->second);
+        s.index.erase(it);
+        return true;
+    }
+
+    void clear(void)
+    {
+        for (size_t i = 0; i < _nshards; i++)
+        {
+            std::lock_guard<std::mutex> lck(_shards[i].mtx);
+            _shards[i].index.clear();
+            _shards[i].lru.clear();
+        }
+    }
+
+    size_t size(void)
+    {
+        size_t n = 0;
+        for (size_t i = 0; i < _nshards; i++)
+        {
+            std::lock_guard<std::mutex> lck(_shards[i].mtx);
+            n += _shards[i].index.size();
+        }
+        return n;
+    }
+
+    size_t capacity(void) const { return _nshards * _shard_capacity; }
+
+    size_t hits(void) const { return _hits; }
+    size_t misses(void) const { return _misses; }
+    size_t evictions(void) const { return _evictions; }
+    void reset_stats(void)
+    {
+        _hits = 0;
+        _misses = 0;
+        _evictions = 0;
+    }
+};
+
+} // namespace opencog
+
+#endif // _OPENCOG_LRU_CACHE_H
@@ -53,77 +53,139 @@ Handle TLB::do_res(const Handle& h)
     return Handle::UNDEFINED;
 }
 
-UUID TLB::addAtom(const Handle& h, UUID uuid)
+// Look up `h` in the (locked) shard; if it's not there, add it, using
+// the given uuid, or a freshly issued one if that is INVALID_UUID.
+// `hr` is the atomspace's version of `h`, if any.
+UUID TLB::insert(HandleShard& hs, const Handle& h, UUID uuid,
+                 const Handle& hr)
 {
-    if (uuid == INVALID_UUID)
+    auto pr = hs.map.find(h);
+    if (hs.map.end() != pr)
     {
-        std::lock_guard<std::mutex> lck(_mtx);
-        auto pr = _handle_map.find(h);
-        if (_handle_map.end() != pr)
-        {
-            uuid = pr->second;
-            Handle hr = do_res(pr->first);
-            if (nullptr == hr) return uuid;
-            if (hr == pr->first) return uuid;
-
-            // Make sure that we always store the atomspaces
-            // version (as its the one with the right TV on it).
-            _handle_map.erase(pr);
-            _uuid_map.erase(uuid);
-
-            _handle_map.emplace(std::make_pair(hr, uuid));
-            _uuid_map.emplace(std::make_pair(uuid, hr));
-            return uuid;
-        }
+        UUID known = pr->second;
+        if (nullptr == hr) return known;
+        if (hr == pr->first) return known;
+
+        // Make sure that we always store the atomspaces
+        // version (as its the one with the right TV on it).
+        hs.map.erase(pr);
+        hs.map.emplace(std::make_pair(hr, known));
+
+        UUIDShard& us = uuid_shard(known);
+        std::lock_guard<std::mutex> lck(us.mtx);
+        us.map[known] = hr;
+        return known;
+    }
 
+    if (INVALID_UUID == uuid)
         uuid = _brk_uuid.fetch_add(1, std::memory_order_relaxed);
-    }
-    else
-    {
-        std::lock_guard<std::mutex> lck(_mtx);
-        auto pr = _handle_map.find(h);
-        if (_handle_map.end() != pr)
-        {
-            if (uuid != pr->second)
-                throw InvalidParamException(TRACE_INFO,
-                     "Atom is already in the TLB, and UUID's don't match!");
-
-            Handle hr = do_res(pr->first);
-            if (nullptr == hr) return uuid;
-            if (hr == pr->first) return uuid;
-
-            // Make sure that we always store the atomspaces
-            // version (as its the one with the right TV on it).
-            _handle_map.erase(pr);
-            _uuid_map.erase(uuid);
-
-            _handle_map.emplace(std::make_pair(hr, uuid));
-            _uuid_map.emplace(std::make_pair(uuid, hr));
-
-            return uuid;
-        }
-
-        reserve_upto(uuid);
-    }
 
     // We need to always use the atomspace version of this handle
-    Handle hr = do_res(h);
-    if (nullptr == hr) hr = h;
-
-    std::lock_guard<std::mutex> lck(_mtx);
-    _uuid_map.emplace(std::make_pair(uuid, hr));
-    _handle_map.emplace(std::make_pair(hr, uuid));
+    const Handle& hins = (nullptr == hr) ? h : hr;
+    hs.map.emplace(std::make_pair(hins, uuid));
 
+    UUIDShard& us = uuid_shard(uuid);
+    std::lock_guard<std::mutex> lck(us.mtx);
+    us.map.emplace(std::make_pair(uuid, hins));
     return uuid;
 }
 
+UUID TLB::addAtom(const Handle& h, UUID uuid)
+{
+    // Resolve before locking; the resolver takes the AtomTable lock.
+    Handle hr(do_res(h));
+
+    HandleShard& hs = handle_shard(h);
+    std::lock_guard<std::mutex> lck(hs.mtx);
+    if (INVALID_UUID != uuid)
+    {
+        auto pr = hs.map.find(h);
+        if (hs.map.end() != pr and uuid != pr->second)
+            throw InvalidParamException(TRACE_INFO,
+                 "Atom is already in the TLB, and UUID's don't match!");
+        if (hs.map.end() == pr)
+            reserve_upto(uuid);
+    }
+    return insert(hs, h, uuid, hr);
+}
+
+std::vector<UUID> TLB::addAtoms(const HandleSeq& hseq)
+{
+    size_t sz = hseq.size();
+    std::vector<UUID> uuids(sz, INVALID_UUID);
+    HandleSeq resolved(sz);
+
+    // First pass: pick up the UUID's of the atoms already known.
+    size_t nmissing = 0;
+    for (size_t i = 0; i < sz; i++)
+    {
+        resolved[i] = do_res(hseq[i]);
+        HandleShard& hs = handle_shard(hseq[i]);
+        std::lock_guard<std::mutex> lck(hs.mtx);
+        if (hs.map.end() == hs.map.find(hseq[i])) nmissing++;
+        else uuids[i] = insert(hs, hseq[i], INVALID_UUID, resolved[i]);
+    }
+    if (0 == nmissing) return uuids;
+
+    // Second pass: issue the rest from one contiguous reservation.
+    // An atom may have been added by another thread in the meanwhile,
+    // or appear twice in the sequence; the UUID reserved for it then
+    // simply goes unused.
+    UUID next = reserve_extent(nmissing);
+    for (size_t i = 0; i < sz; i++)
+    {
+        if (INVALID_UUID != uuids[i]) continue;
+        HandleShard& hs = handle_shard(hseq[i]);
+        std::lock_guard<std::mutex> lck(hs.mtx);
+        uuids[i] = insert(hs, hseq[i], next, resolved[i]);
+        if (uuids[i] == next) next++;
+    }
+    return uuids;
+}
+
 Handle TLB::getAtom(UUID uuid)
 {
     if (INVALID_UUID == uuid) return Handle::UNDEFINED;
-    std::lock_guard<std::mutex> lck(_mtx);
-    auto pr = _uuid_map.find(uuid);
+    UUIDShard& us = uuid_shard(uuid);
+    std::lock_guard<std::mutex> lck(us.mtx);
+    auto pr = us.map.find(uuid);
+
+    if (us.map.end() == pr) return Handle::UNDEFINED;
+
+    return pr->second;
+}
+
+UUID TLB::getUUID(const Handle& h)
+{
+    HandleShard& hs = handle_shard(h);
+    std::lock_guard<std::mutex> lck(hs.mtx);
+    auto pr = hs.map.find(h);
 
-    if (_uuid_map.end() == pr) return Handle::UNDEFINED;
+    if (hs.map.end() == pr) return INVALID_UUID;
 
     return pr->second;
 }
+
+void TLB::removeAtom(const Handle& h)
+{
+    HandleShard& hs = handle_shard(h);
+    std::lock_guard<std::mutex> lck(hs.mtx);
+    auto pr = hs.map.find(h);
+    if (hs.map.end() == pr) return;
+
+    UUIDShard& us = uuid_shard(pr->second);
+    std::lock_guard<std::mutex> ulck(us.mtx);
+    us.map.erase(pr->second);
+    hs.map.erase(pr);
+}
+
+size_t TLB::size(void)
+{
+    size_t n = 0;
+    for (size_t i = 0; i < NSHARDS; i++)
+    {
+        std::lock_guard<std::mutex> lck(_uuid_shards[i].mtx);
+        n += _uuid_shards[i].map.size();
+    }
+    return n;
+}
@@ -28,6 +28,7 @@
 #include <atomic>
 #include <mutex>
 #include <unordered_map>
+#include <vector>
 
 #include <opencog/atoms/base/Atom.h>
 #include <opencog/atoms/base/Handle.h>
@@ -62,16 +63,44 @@ private:
     // Thread-safe atomic
     std::atomic<UUID> _brk_uuid;
 
-    std::mutex _mtx;
-    std::unordered_map<UUID, Handle> _uuid_map;
-    std::unordered_map<Handle, UUID,
-                      std::hash<opencog::Handle>,
-                      std::equal_to<opencog::Handle> > _handle_map;
+    // Both maps are split into independently-locked shards, so that
+    // concurrent loads and stores only contend when they touch the
+    // same shard.  The uuid map is sharded by UUID, the handle map by
+    // the (content) hash of the atom.  Whenever both locks are needed,
+    // the handle shard is locked first.
+    static const size_t NSHARDS = 64;
+
+    struct UUIDShard
+    {
+        std::mutex mtx;
+        std::unordered_map<UUID, Handle> map;
+    };
+    struct HandleShard
+    {
+        std::mutex mtx;
+        std::unordered_map<Handle, UUID,
+                           std::hash<opencog::Handle>,
+                           std::equal_to<opencog::Handle> > map;
+    };
+    UUIDShard _uuid_shards[NSHARDS];
+    HandleShard _handle_shards[NSHARDS];
+
+    UUIDShard& uuid_shard(UUID uuid)
+    {
+        return _uuid_shards[uuid % NSHARDS];
+    }
+    HandleShard& handle_shard(const Handle& h)
+    {
+        size_t hv = std::hash<opencog::Handle>()(h);
+        return _handle_shards[(hv ^ (hv >> 17)) % NSHARDS];
+    }
 
     // Its a vector, not a set, because its priority ranked.
     std::vector<const AtomTable*> _resolver;
     Handle do_res(const Handle&);
 
+    UUID insert(HandleShard&, const Handle&, UUID, const Handle&);
+
 public:
 
     static const UUID INVALID_UUID = ULONG_MAX;
@@ -92,8 +121,33 @@ public:
     }
     UUID addAtom(const Handle&, UUID);
 
+    /**
+     * Adds many atoms to the TLB at once, returning their UUID's, in
+     * order.  Atoms that are already in the TLB keep their UUID's;
+     * the others are issued consecutive UUID's from a single range
+     * reservation.
+     */
+    std::vector<UUID> addAtoms(const HandleSeq&);
+
     Handle getAtom(UUID);
 
+    /**
+     * Return the UUID of the atom, or INVALID_UUID if it has none.
+     * Unlike addAtom(), this never issues a new UUID.
+     */
+    UUID getUUID(const Handle&);
+
+    /**
+     * Forget the UUID assigned to an atom.  The UUID itself is not
+     * freed, and will not be issued again; the mapping must be
+     * restored with addAtom(h, uuid) if the atom is needed later.
+     * This is used to keep the TLB bounded when atoms are evicted
+     * from RAM back to persistent storage.
+     */
+    void removeAtom(const Handle&);
+
+    size_t size(void);
+
     UUID getMaxUUID(void) { return _brk_uuid; }
 
     /// Reserve a range of UUID's.  The range is inclusive; both lo and
@@ -0,0 +1,108 @@
+/*
+ * opencog/atomutils/ExecControl.cc
+ *
+ * Cancellation and deadlines for long-running executions.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <opencog/util/exceptions.h>
+
+#include "ExecControl.h"
+
+using namespace opencog;
+
+static thread_local ExecControl* tl_control = nullptr;
+
+ExecControl::ExecControl(std::chrono::milliseconds timeout) :
+	_cancelled(false),
+	_has_deadline(timeout.count() > 0),
+	_steps(0),
+	_max_steps(SIZE_MAX),
+	_next_id(0)
+{
+	if (_has_deadline)
+		_deadline = Clock::now() + timeout;
+}
+
+void ExecControl::cancel(void)
+{
+	_cancelled = true;
+
+	// The interrupts are run without the lock held, so that they may
+	// block, e.g. to enter guile, without holding up remove_interrupt().
+	std::vector<std::pair<size_t, Interrupt>> irqs;
+	{
+		std::lock_guard<std::mutex> lck(_mtx);
+		irqs = _interrupts;
+	}
+	for (auto& irq : irqs) irq.second();
+}
+
+bool ExecControl::is_cancelled(void) const
+{
+	if (_cancelled) return true;
+	if (_max_steps < _steps) return true;
+	return _has_deadline and _deadline <= Clock::now();
+}
+
+void ExecControl::check(void) const
+{
+	if (_cancelled)
+		throw RuntimeException(TRACE_INFO, "Execution was cancelled");
+
+	if (_max_steps < _steps)
+		throw RuntimeException(TRACE_INFO,
+			"Execution step budget of %zu exhausted", _max_steps);
+
+	if (_has_deadline and _deadline <= Clock::now())
+		throw RuntimeException(TRACE_INFO, "Execution deadline exceeded");
+}
+
+size_t ExecControl::add_interrupt(Interrupt irq)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	size_t id = _next_id++;
+	_interrupts.emplace_back(id, irq);
+	return id;
+}
+
+void ExecControl::remove_interrupt(size_t id)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	for (auto it = _interrupts.begin(); it != _interrupts.end(); it++)
+	{
+		if (it->first != id) continue;
+		_interrupts.erase(it);
+		return;
+	}
+}
+
+ExecControl* ExecControl::current(void)
+{
+	return tl_control;
+}
+
+ExecControl::Scope::Scope(ExecControl* ctl) :
+	_saved(tl_control)
+{
+	tl_control = ctl;
+}
+
+ExecControl::Scope::~Scope()
+{
+	tl_control = _saved;
+}
@@ -0,0 +1,137 @@
+/*
+ * opencog/atomutils/ExecControl.h
+ *
+ * Cancellation and deadlines for long-running executions.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_EXEC_CONTROL_H
+#define _OPENCOG_EXEC_CONTROL_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace opencog
+{
+/** \addtogroup grp_atomspace
+ *  @{
+ */
+
+/**
+ * Cancellation flag, optional deadline and optional step budget for
+ * one execution, such as a query, or the evaluation of an
+ * EvaluationLink.
+ *
+ * Cancellation is cooperative.  The code doing the work installs the
+ * control for its thread with a Scope, and then calls check_current()
+ * at convenient points: the evaluator and the instantiator check on
+ * entry, and the implicator between groundings.  The pattern matcher
+ * engine polls through step(), counting one step per term comparison.
+ * Once the control is cancelled, its deadline has passed, or its step
+ * budget is spent, check() throws a RuntimeException, which unwinds
+ * the execution.  Without a control installed, check_current() costs
+ * one thread-local load.
+ *
+ * Code that cannot poll, such as a scheme procedure stuck in a loop,
+ * registers an interrupt with add_interrupt(); cancel() calls it.
+ */
+class ExecControl
+{
+	public:
+		typedef std::chrono::steady_clock Clock;
+		typedef std::function<void(void)> Interrupt;
+
+	private:
+		std::atomic_bool _cancelled;
+		bool _has_deadline;
+		Clock::time_point _deadline;
+
+		std::atomic<size_t> _steps;
+		size_t _max_steps;
+
+		std::mutex _mtx;
+		size_t _next_id;
+		std::vector<std::pair<size_t, Interrupt>> _interrupts;
+
+	public:
+		/// A zero timeout means no deadline.
+		ExecControl(std::chrono::milliseconds timeout =
+		                std::chrono::milliseconds::zero());
+		ExecControl(const ExecControl&) = delete;
+		ExecControl& operator=(const ExecControl&) = delete;
+
+		/// Ask the execution to stop, and run the interrupts.
+		void cancel(void);
+
+		bool has_deadline(void) const { return _has_deadline; }
+		Clock::time_point get_deadline(void) const { return _deadline; }
+
+		/// Limit the work done; set this before the execution starts.
+		void set_step_budget(size_t steps) { _max_steps = steps; }
+		size_t get_steps(void) const { return _steps; }
+
+		/// Count `n` more steps of work, then check().
+		void step(size_t n)
+		{
+			_steps += n;
+			check();
+		}
+
+		/// True if cancelled, or out of time or steps.
+		bool is_cancelled(void) const;
+
+		/// Throw a RuntimeException if is_cancelled().
+		void check(void) const;
+
+		/// Register an interrupt; returns an id for remove_interrupt().
+		/// The interrupt may be called after it has been removed, by
+		/// a cancel() that started before the removal, and so must
+		/// tolerate being called late.
+		size_t add_interrupt(Interrupt);
+		void remove_interrupt(size_t);
+
+		/// The control installed for this thread, or null.
+		static ExecControl* current(void);
+
+		static void check_current(void)
+		{
+			ExecControl* ctl = current();
+			if (ctl) ctl->check();
+		}
+
+		/// Install a control for this thread, for the life of the
+		/// Scope.  A null control makes the scope uncancellable.
+		class Scope
+		{
+			ExecControl* _saved;
+		public:
+			Scope(ExecControl*);
+			~Scope();
+			Scope(const Scope&) = delete;
+			Scope& operator=(const Scope&) = delete;
+		};
+};
+
+/** @}*/
+} //namespace opencog
+
+#endif // _OPENCOG_EXEC_CONTROL_H
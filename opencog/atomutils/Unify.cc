@@ -27,7 +27,11 @@
 
 #include "Unify.h"
 
+#include <map>
+#include <vector>
+
 #include <opencog/util/algorithm.h>
+#include <opencog/atoms/base/ClassServer.h>
 #include <opencog/atoms/base/Atom.h>
 #include <opencog/atoms/base/Node.h>
 #include <opencog/atomutils/FindUtils.h>
@@ -73,9 +77,436 @@ TypedSubstitutions typed_substitutions(const UnificationSolutionSet& sol,
 	return result;
 }
 
+namespace {
+
+/**
+ * Union-find unifier, behind unify().
+ *
+ * Both atoms are first flattened into a vector of compact terms, the
+ * children of a link stored next to each other.  The unifier then
+ * walks an agenda of term pairs, in the order in which
+ * recursive_unify() joins their solutions.  A pair holding a variable
+ * puts its two atoms in the same equivalence class; the classes are
+ * kept in a union-find structure, each with its type, intersected on
+ * every merge, so that a mismatch fails right away.  Links must agree
+ * on type and arity before their children are paired.
+ *
+ * Unordered links branch over the permutations of their children.
+ * Every change to the classes is recorded on a trail, and undone when
+ * backtracking.  Each branch that completes, and passes the occurs
+ * check, adds its partition to the solution set.
+ */
+class Unifier
+{
+public:
+	Unifier(const Handle& lhs_vardecl, const Handle& rhs_vardecl);
+
+	UnificationSolutionSet operator()(const Handle& lhs, const Handle& rhs);
+
+private:
+	struct Term
+	{
+		Handle h;
+		Type type;
+		bool is_var;
+		bool is_node;
+		Arity arity;
+		size_t children;        // Index of the first child
+	};
+
+	// Either a pair of terms, or the children of an unordered pair
+	// that remain to be paired.
+	struct Item
+	{
+		size_t lhs;
+		size_t rhs;
+		bool unordered;
+		std::vector<size_t> lhs_rest;
+		std::vector<size_t> rhs_rest;
+	};
+
+	struct Undo
+	{
+		size_t elem;
+		size_t parent;
+		size_t size;
+		Handle type;
+		bool created;
+	};
+
+	// Null when the vardecl is undefined, that is all variables are
+	// declared, and untyped.
+	VariableListPtr _lhs_vars;
+	VariableListPtr _rhs_vars;
+
+	std::vector<Term> _terms;
+
+	// Class elements, indexed by content, as OrderedHandleSet is
+	std::map<Handle, size_t> _index;
+	std::vector<Handle> _elems;
+	std::vector<size_t> _parent;
+	std::vector<size_t> _size;
+	std::vector<Handle> _type;     // Type of the class, at its root
+	std::vector<Undo> _trail;
+
+	bool _satisfiable;
+	UnificationPartitions _partitions;
+
+	size_t add_term(const Handle& h);
+	void add_children(size_t i);
+
+	void solve(std::vector<Item> agenda);
+	bool step(size_t l, size_t r, std::vector<Item>& agenda);
+	bool clash(size_t l, size_t r) const;
+	bool bind(const Handle& lh, const Handle& rh);
+	void add_solution();
+	bool occurs(size_t root, std::vector<char>& state);
+
+	size_t element(const Handle& h);
+	size_t find(size_t e) const;
+	size_t unite(size_t a, size_t b);
+	void save(size_t e);
+	void undo(size_t mark);
+
+	bool inherit(const Handle& lh, const Handle& rh,
+	             const VariableListPtr& lvars,
+	             const VariableListPtr& rvars) const;
+	Handle intersect(const Handle& lh, const Handle& rh) const;
+	static Handle merge_types(const Handle& t_new, const Handle& t_old);
+	static const std::set<Type>& union_type(const Handle& var,
+	                                        const VariableListPtr& vars);
+};
+
+static VariableListPtr declared_varlist(const Handle& vardecl)
+{
+	if (vardecl.is_undefined())
+		return nullptr;
+	// The atom is only used when the vardecl is undefined
+	return gen_varlist(Handle::UNDEFINED, vardecl);
+}
+
+Unifier::Unifier(const Handle& lhs_vardecl, const Handle& rhs_vardecl)
+	: _lhs_vars(declared_varlist(lhs_vardecl)),
+	  _rhs_vars(declared_varlist(rhs_vardecl)),
+	  _satisfiable(false)
+{
+}
+
+UnificationSolutionSet Unifier::operator()(const Handle& lhs,
+                                           const Handle& rhs)
+{
+	if (lhs == Handle::UNDEFINED or rhs == Handle::UNDEFINED)
+		return UnificationSolutionSet(false);
+
+	size_t l = add_term(lhs);
+	add_children(l);
+	size_t r = add_term(rhs);
+	add_children(r);
+
+	solve({{l, r, false, {}, {}}});
+	return UnificationSolutionSet(_satisfiable, _partitions);
+}
+
+size_t Unifier::add_term(const Handle& h)
+{
+	Type t = h->getType();
+	_terms.push_back({h, t, VARIABLE_NODE == t, h->isNode(),
+	                  h->isLink() ? h->getArity() : 0, 0});
+	return _terms.size() - 1;
+}
+
+void Unifier::add_children(size_t i)
+{
+	if (_terms[i].is_node)
+		return;
+
+	size_t first = _terms.size();
+	_terms[i].children = first;
+	Handle h(_terms[i].h);
+	for (const Handle& child : h->getOutgoingSet())
+		add_term(child);
+	for (size_t k = first; k < first + h->getArity(); k++)
+		add_children(k);
+}
+
+void Unifier::solve(std::vector<Item> agenda)
+{
+	while (not agenda.empty()) {
+		Item item(std::move(agenda.back()));
+		agenda.pop_back();
+
+		if (not item.unordered) {
+			if (not step(item.lhs, item.rhs, agenda))
+				return;
+			continue;
+		}
+		if (item.rhs_rest.empty())
+			continue;
+
+		// Pair the first remaining rhs child with each remaining lhs
+		// child in turn, as unordered_unify() does.
+		size_t r = item.rhs_rest.front();
+		for (size_t i = 0; i < item.lhs_rest.size(); i++) {
+			size_t l = item.lhs_rest[i];
+			if (clash(l, r))
+				continue;
+
+			std::vector<Item> branch(agenda);
+			Item rest{0, 0, true, item.lhs_rest,
+			          std::vector<size_t>(item.rhs_rest.begin() + 1,
+			                              item.rhs_rest.end())};
+			rest.lhs_rest.erase(rest.lhs_rest.begin() + i);
+			branch.push_back(std::move(rest));
+			branch.push_back({l, r, false, {}, {}});
+
+			size_t mark = _trail.size();
+			solve(std::move(branch));
+			undo(mark);
+		}
+		return;
+	}
+	add_solution();
+}
+
+bool Unifier::step(size_t l, size_t r, std::vector<Item>& agenda)
+{
+	const Term& lt = _terms[l];
+	const Term& rt = _terms[r];
+
+	if (lt.is_node or rt.is_node) {
+		if (lt.is_var or rt.is_var)
+			return bind(lt.h, rt.h);
+		return lt.h == rt.h;
+	}
+
+	if (lt.type != rt.type or lt.arity != rt.arity)
+		return false;
+
+	if (classserver().isA(rt.type, UNORDERED_LINK)) {
+		Item item{0, 0, true, {}, {}};
+		for (Arity k = 0; k < lt.arity; k++) {
+			item.lhs_rest.push_back(lt.children + k);
+			item.rhs_rest.push_back(rt.children + k);
+		}
+		agenda.push_back(std::move(item));
+	} else {
+		// Pushed in reverse, so that the first children pop first
+		for (Arity k = lt.arity; 0 < k; k--)
+			agenda.push_back({lt.children + k - 1, rt.children + k - 1,
+			                  false, {}, {}});
+	}
+	return true;
+}
+
+// True if the two terms cannot unify, whatever the classes are.  Used
+// to prune the permutations of unordered links.
+bool Unifier::clash(size_t l, size_t r) const
+{
+	const Term& lt = _terms[l];
+	const Term& rt = _terms[r];
+	if (lt.is_var or rt.is_var)
+		return false;
+	if (lt.is_node or rt.is_node)
+		return lt.h != rt.h;
+	if (lt.type != rt.type or lt.arity != rt.arity)
+		return true;
+	if (classserver().isA(rt.type, UNORDERED_LINK))
+		return false;
+	for (Arity k = 0; k < lt.arity; k++)
+		if (clash(lt.children + k, rt.children + k))
+			return true;
+	return false;
+}
+
+bool Unifier::bind(const Handle& lh, const Handle& rh)
+{
+	Handle inter = intersect(lh, rh);
+	if (inter == Handle::UNDEFINED)
+		return false;
+
+	size_t lroot = find(element(lh));
+	size_t rroot = find(element(rh));
+
+	Handle type = merge_types(inter, _type[lroot]);
+	if (type != Handle::UNDEFINED and lroot != rroot)
+		type = merge_types(type, _type[rroot]);
+	if (type == Handle::UNDEFINED)
+		return false;
+
+	size_t root = unite(lroot, rroot);
+	save(root);
+	_type[root] = type;
+	return true;
+}
+
+void Unifier::add_solution()
+{
+	std::vector<char> state(_elems.size(), 0);
+	for (size_t e = 0; e < _elems.size(); e++)
+		if (find(e) == e and 0 == state[e] and occurs(e, state))
+			return;
+
+	_satisfiable = true;
+
+	std::map<size_t, OrderedHandleSet> blocks;
+	for (size_t e = 0; e < _elems.size(); e++)
+		blocks[find(e)].insert(_elems[e]);
+
+	UnificationPartition partition;
+	for (const auto& block : blocks)
+		partition.insert({block.second, _type[block.first]});
+	if (not partition.empty())
+		_partitions.insert(partition);
+}
+
+// Occurs check: true if the type of the class, through the variables
+// it holds, leads back to the class.
+bool Unifier::occurs(size_t root, std::vector<char>& state)
+{
+	state[root] = 1;
+	const Handle& type = _type[root];
+	if (type->isLink()) {
+		for (const Handle& var : get_free_variables(type)) {
+			auto it = _index.find(var);
+			if (it == _index.end())
+				continue;
+			size_t vroot = find(it->second);
+			if (1 == state[vroot])
+				return true;
+			if (0 == state[vroot] and occurs(vroot, state))
+				return true;
+		}
+	}
+	state[root] = 2;
+	return false;
+}
+
+size_t Unifier::element(const Handle& h)
+{
+	auto it = _index.find(h);
+	if (it != _index.end())
+		return it->second;
+
+	size_t e = _elems.size();
+	_index.insert({h, e});
+	_elems.push_back(h);
+	_parent.push_back(e);
+	_size.push_back(1);
+	_type.push_back(Handle::UNDEFINED);
+	_trail.push_back({e, e, 1, Handle::UNDEFINED, true});
+	return e;
+}
+
+size_t Unifier::find(size_t e) const
+{
+	// No path compression, so that unite() can be undone
+	while (_parent[e] != e)
+		e = _parent[e];
+	return e;
+}
+
+size_t Unifier::unite(size_t a, size_t b)
+{
+	if (a == b)
+		return a;
+	if (_size[a] < _size[b])
+		std::swap(a, b);
+	save(a);
+	save(b);
+	_parent[b] = a;
+	_size[a] += _size[b];
+	return a;
+}
+
+void Unifier::save(size_t e)
+{
+	_trail.push_back({e, _parent[e], _size[e], _type[e], false});
+}
+
+void Unifier::undo(size_t mark)
+{
+	while (mark < _trail.size()) {
+		const Undo& u = _trail.back();
+		if (u.created) {
+			// Elements are created, and so undone, last in first out
+			_index.erase(_elems.back());
+			_elems.pop_back();
+			_parent.pop_back();
+			_size.pop_back();
+			_type.pop_back();
+		} else {
+			_parent[u.elem] = u.parent;
+			_size[u.elem] = u.size;
+			_type[u.elem] = u.type;
+		}
+		_trail.pop_back();
+	}
+}
+
+// Same as opencog::inherit(), with the variable lists built once
+bool Unifier::inherit(const Handle& lh, const Handle& rh,
+                      const VariableListPtr& lvars,
+                      const VariableListPtr& rvars) const
+{
+	if (VARIABLE_NODE == lh->getType() and VARIABLE_NODE == rh->getType())
+		return opencog::inherit(union_type(lh, lvars), union_type(rh, rvars));
+	if (lh == rh)
+		return true;
+	if (nullptr == rvars)
+		return VARIABLE_NODE == rh->getType();
+	return rvars->is_type(rh, lh);
+}
+
+// Same as type_intersection(), used by mkvarsol()
+Handle Unifier::intersect(const Handle& lh, const Handle& rh) const
+{
+	if (inherit(lh, rh, _lhs_vars, _rhs_vars))
+		return lh;
+	if (inherit(rh, lh, _rhs_vars, _lhs_vars))
+		return rh;
+	return Handle::UNDEFINED;
+}
+
+// Same as type_intersection(t_new, t_old) without vardecls, used by
+// join() to merge blocks, where an undefined t_old stands for a new
+// class.  Variables are untyped there, so the non variable type wins,
+// or else the newer one.
+Handle Unifier::merge_types(const Handle& t_new, const Handle& t_old)
+{
+	if (t_old == Handle::UNDEFINED)
+		return t_new;
+	if (VARIABLE_NODE == t_old->getType() or t_new == t_old)
+		return t_new;
+	if (VARIABLE_NODE == t_new->getType())
+		return t_old;
+	return Handle::UNDEFINED;
+}
+
+const std::set<Type>& Unifier::union_type(const Handle& var,
+                                          const VariableListPtr& vars)
+{
+	static const std::set<Type> top{ATOM};
+	if (nullptr == vars)
+		return top;
+	const VariableTypeMap& vtm = vars->get_variables()._simple_typemap;
+	auto it = vtm.find(var);
+	if (it == vtm.end() or it->second.empty())
+		return top;
+	return it->second;
+}
+
+} // ~namespace
+
 UnificationSolutionSet unify(const Handle& lhs, const Handle& rhs,
                              const Handle& lhs_vardecl,
                              const Handle& rhs_vardecl)
+{
+	return Unifier(lhs_vardecl, rhs_vardecl)(lhs, rhs);
+}
+
+UnificationSolutionSet recursive_unify(const Handle& lhs, const Handle& rhs,
+                                       const Handle& lhs_vardecl,
+                                       const Handle& rhs_vardecl)
 {
 	///////////////////
 	// Base cases    //
@@ -136,7 +567,8 @@ UnificationSolutionSet unordered_unify(const HandleSeq& lhs,
 	// Recursive case
 	UnificationSolutionSet sol(false);
 	for (Arity i = 0; i < lhs_arity; ++i) {
-		auto head_sol = unify(lhs[i], rhs[0], lhs_vardecl, rhs_vardecl);
+		auto head_sol = recursive_unify(lhs[i], rhs[0],
+		                                lhs_vardecl, rhs_vardecl);
 		if (head_sol.satisfiable) {
 			HandleSeq lhs_tail(cp_erase(lhs, i));
 			HandleSeq rhs_tail(cp_erase(rhs, 0));
@@ -165,7 +597,7 @@ UnificationSolutionSet ordered_unify(const HandleSeq& lhs,
 
 	UnificationSolutionSet sol;
 	for (Arity i = 0; i < lhs_arity; ++i) {
-		auto rs = unify(lhs[i], rhs[i], lhs_vardecl, rhs_vardecl);
+		auto rs = recursive_unify(lhs[i], rhs[i], lhs_vardecl, rhs_vardecl);
 		sol = join(sol, rs);
 		if (not sol.satisfiable)     // Stop if unification has failed
 			break;
@@ -159,11 +159,27 @@ TypedSubstitutions typed_substitutions(const UnificationSolutionSet& sol,
  * A and Y unifies to B, and another one where X unifies to B and Y
  * unifies to A.
  *
+ * The partitions are built with a union-find structure over the
+ * atoms of both terms, so that no intermediary solution set is
+ * copied, and failing as soon as a type intersection is empty.  A
+ * solution binding a variable to a term that holds that variable,
+ * directly or through other variables, fails the occurs check and is
+ * discarded.
+ *
  * TODO: take care of Un/Quote and Scope links.
  */
 UnificationSolutionSet unify(const Handle& lhs, const Handle& rhs,
                              const Handle& lhs_vardecl = Handle::UNDEFINED,
                              const Handle& rhs_vardecl = Handle::UNDEFINED);
+
+/**
+ * Same as unify(), but by recursively joining the solution sets of
+ * the subterms, without the occurs check.  This was the former
+ * implementation of unify(), kept for comparison.
+ */
+UnificationSolutionSet recursive_unify(const Handle& lhs, const Handle& rhs,
+                                       const Handle& lhs_vardecl = Handle::UNDEFINED,
+                                       const Handle& rhs_vardecl = Handle::UNDEFINED);
 UnificationSolutionSet unordered_unify(const HandleSeq& lhs,
                                        const HandleSeq& rhs,
                                        const Handle& lhs_vardecl,
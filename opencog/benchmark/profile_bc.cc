@@ -0,0 +1,112 @@
+/*
+ * benchmark/profile_bc.cc
+ *
+ * Time spent per backward chainer step on the bc-*.scm unit test
+ * problems, and how often rule unification is answered from the
+ * BackwardChainer unification cache.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <opencog/atomspace/AtomSpace.h>
+#include <opencog/guile/SchemeEval.h>
+#include <opencog/rule-engine/backwardchainer/BackwardChainer.h>
+#include <opencog/util/Logger.h>
+#include <opencog/util/mt19937ar.h>
+
+using namespace opencog;
+
+AtomSpace *atomspace;
+SchemeEval *scheme;
+
+const int iterations = 100;
+
+// Load a config and a knowledge base, as BackwardChainerUTest does.
+void load(const std::string& config, const std::string& kb)
+{
+    atomspace->clear();
+    scheme->eval("(load-from-path \"tests/rule-engine/" + config + "\")");
+    scheme->eval("(load-from-path \"tests/rule-engine/" + kb + "\")");
+    randGen().seed(0);
+}
+
+void run(const char* what, const Handle& target,
+         const Handle& vardecl = Handle::UNDEFINED)
+{
+    Handle top_rbs = atomspace->get_node(CONCEPT_NODE,
+                                         UREConfigReader::top_rbs_name);
+    BackwardChainer bc(*atomspace, top_rbs, target, vardecl);
+    bc.get_config().set_maximum_iterations(iterations);
+
+    int steps = 0;
+    auto start = std::chrono::steady_clock::now();
+    while (not bc.termination())
+    {
+        bc.do_step();
+        steps++;
+    }
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    size_t hits = bc.get_unify_cache_hits(),
+        lookups = hits + bc.get_unify_cache_misses();
+    std::cout << what << ": " << steps << " steps\n"
+              << "   per step:   " << 1e3 * elapsed.count() / steps
+              << " msecs\n"
+              << "   cache hits: " << hits << " of " << lookups << " ("
+              << (lookups ? 100.0 * hits / lookups : 0.0) << "%)\n";
+}
+
+int main(void)
+{
+    logger().set_level(Logger::WARN);
+
+    atomspace = new AtomSpace();
+    scheme = new SchemeEval(atomspace);
+
+    std::string src(PROJECT_SOURCE_DIR);
+    for (const std::string& p : {src, src + "/tests",
+                                 src + "/tests/rule-engine"})
+        scheme->eval("(add-to-load-path \"" + p + "\")");
+    scheme->eval("(use-modules (opencog))");
+
+    load("bc-deduction-config.scm", "bc-transitive-closure.scm");
+    run("deduction",
+        atomspace->add_link(INHERITANCE_LINK,
+            atomspace->add_node(VARIABLE_NODE, "$X"),
+            atomspace->add_node(CONCEPT_NODE, "D")));
+
+    load("bc-modus-ponens-config.scm", "modus-ponens-example.scm");
+    run("modus ponens", atomspace->add_node(PREDICATE_NODE, "T"));
+
+    load("conditional-instantiation-config.scm", "bc-friends.scm");
+    Handle who = atomspace->add_node(VARIABLE_NODE, "$who");
+    run("conditional instantiation",
+        atomspace->add_link(EVALUATION_LINK,
+            atomspace->add_node(PREDICATE_NODE, "are-friends"),
+            atomspace->add_link(LIST_LINK, who,
+                atomspace->add_node(CONCEPT_NODE, "John"))),
+        atomspace->add_link(VARIABLE_LIST,
+            atomspace->add_link(TYPED_VARIABLE_LINK, who,
+                atomspace->add_node(TYPE_NODE, "ConceptNode"))));
+
+    return 0;
+}
@@ -0,0 +1,107 @@
+/*
+ * benchmark/profile_parallel.cc
+ *
+ * Cost of evaluating JoinLink members on a fresh thread each, as
+ * JoinLink used to, against the shared EvaluationPool.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <opencog/atomspace/AtomSpace.h>
+#include <opencog/atoms/execution/EvaluationLink.h>
+#include <opencog/atoms/execution/EvaluationPool.h>
+#include <opencog/guile/SchemeEval.h>
+#include <opencog/util/Logger.h>
+
+using namespace opencog;
+
+AtomSpace *atomspace;
+
+const int members = 100;
+const int rounds = 200;
+
+// A JoinLink-worth of members, evaluated one thread per member.
+double run_threads(const HandleSeq& oset)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++)
+    {
+        std::vector<std::thread> thread_set;
+        for (const Handle& h : oset)
+            thread_set.push_back(std::thread([h]() {
+                EvaluationLink::do_evaluate(atomspace, h);
+            }));
+        for (std::thread& t : thread_set) t.join();
+    }
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+// The same, through JoinLink, and so the shared pool.
+double run_pool(const Handle& join)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++)
+        EvaluationLink::do_evaluate(atomspace, join);
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+void compare(const char* what, const HandleSeq& oset)
+{
+    Handle join = atomspace->add_link(JOIN_LINK, oset);
+
+    double tthr = run_threads(oset);
+    double tpool = run_pool(join);
+    std::cout << what << ": "
+              << rounds << " joins of " << members << " members\n"
+              << "   thread per member: " << tthr << " secs\n"
+              << "   shared pool:       " << tpool << " secs ("
+              << EvaluationPool::instance().size() << " workers)\n";
+}
+
+int main(void)
+{
+    atomspace = new AtomSpace();
+
+    // Trivial members: this is all thread overhead.
+    HandleSeq trivial;
+    for (int i = 0; i < members; i++)
+        trivial.push_back(atomspace->add_link(TRUE_LINK,
+            atomspace->add_node(NUMBER_NODE, std::to_string(i))));
+    compare("TrueLink members", trivial);
+
+    // Scheme members: each new thread also sets up guile.
+    SchemeEval* scheme = SchemeEval::get_evaluator(atomspace);
+    scheme->eval("(use-modules (opencog) (opencog exec))");
+    scheme->eval("(define (ok x) (stv 1 1))");
+    HandleSeq scm;
+    for (int i = 0; i < members; i++)
+        scm.push_back(atomspace->add_link(EVALUATION_LINK,
+            atomspace->add_node(GROUNDED_PREDICATE_NODE, "scm: ok"),
+            atomspace->add_link(LIST_LINK,
+                atomspace->add_node(NUMBER_NODE, std::to_string(i)))));
+    compare("scm: members", scm);
+
+    return 0;
+}
@@ -0,0 +1,94 @@
+/*
+ * benchmark/profile_scm_threads.cc
+ *
+ * Throughput of cog-execute! on scheme-grounded schemas, for one to
+ * many threads sharing one AtomSpace.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <opencog/guile/SchemeEval.h>
+#include <opencog/atomspace/AtomSpace.h>
+#include <opencog/util/Logger.h>
+
+using namespace opencog;
+
+AtomSpace *atomspace;
+
+const int execs_per_thread = 20000;
+
+void load_scheme()
+{
+    SchemeEval* scheme = SchemeEval::get_evaluator(atomspace);
+    scheme->eval("(use-modules (opencog) (opencog exec))");
+    scheme->eval("(define (add-one n)"
+                 "   (NumberNode (+ 1 (cog-number n))))");
+}
+
+void execute_loop(int thread_id)
+{
+    // Each thread gets its own evaluator from the pool.
+    SchemeEval* scheme = SchemeEval::get_evaluator(atomspace);
+    // No top-level defines here: guile's module is shared by all
+    // threads.
+    std::string exec =
+        "(cog-execute! (ExecutionOutputLink"
+        " (GroundedSchemaNode \"scm: add-one\")"
+        " (ListLink (NumberNode " + std::to_string(thread_id) + "))))";
+
+    for (int i = 0; i < execs_per_thread; i++)
+        scheme->eval_h(exec);
+}
+
+double run(int n_threads)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> pool;
+    for (int i = 0; i < n_threads; i++)
+        pool.push_back(std::thread(execute_loop, i));
+    for (std::thread& t : pool) t.join();
+
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return (n_threads * execs_per_thread) / elapsed.count();
+}
+
+int main(int argc, char* argv[])
+{
+    int max_threads = std::thread::hardware_concurrency();
+    if (1 < argc) max_threads = atoi(argv[1]);
+    if (max_threads < 1) max_threads = 1;
+
+    atomspace = new AtomSpace();
+    load_scheme();
+
+    // Definitions are done; drop the guile-wide lock, where there is one.
+    SchemeEval::enable_threads();
+
+    std::cout << "threads\texecs/sec" << std::endl;
+    for (int n = 1; n <= max_threads; n *= 2)
+        std::cout << n << "\t" << (long) run(n) << std::endl;
+
+    delete atomspace;
+    return 0;
+}
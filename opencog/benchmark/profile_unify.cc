@@ -0,0 +1,112 @@
+/*
+ * benchmark/profile_unify.cc
+ *
+ * Cost of unify(), which builds its partitions with union-find,
+ * against recursive_unify(), which joins the solution sets of the
+ * subterms.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include <opencog/atomspace/AtomSpace.h>
+#include <opencog/atomutils/Unify.h>
+
+using namespace opencog;
+
+AtomSpace *atomspace;
+
+const int rounds = 2000;
+const int width = 6;
+
+typedef UnificationSolutionSet (*Unify)(const Handle&, const Handle&,
+                                        const Handle&, const Handle&);
+
+double run(Unify fn, const Handle& lhs, const Handle& rhs,
+           const Handle& lhs_vardecl, const Handle& rhs_vardecl,
+           UnificationSolutionSet& sol)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++)
+        sol = fn(lhs, rhs, lhs_vardecl, rhs_vardecl);
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+void compare(const char* what, const Handle& lhs, const Handle& rhs,
+             const Handle& lhs_vardecl = Handle::UNDEFINED,
+             const Handle& rhs_vardecl = Handle::UNDEFINED)
+{
+    UnificationSolutionSet usol, rsol;
+    double tuf = run(unify, lhs, rhs, lhs_vardecl, rhs_vardecl, usol);
+    double trec = run(recursive_unify, lhs, rhs, lhs_vardecl, rhs_vardecl, rsol);
+    std::cout << what << ": " << rounds << " unifications, "
+              << usol.partitions.size() << " partitions"
+              << (usol == rsol ? "" : " (RESULTS DIFFER)") << "\n"
+              << "   union-find: " << tuf << " secs\n"
+              << "   recursive:  " << trec << " secs\n";
+}
+
+int main(void)
+{
+    atomspace = new AtomSpace();
+
+    Handle ct = atomspace->add_node(TYPE_NODE, "ConceptNode");
+    HandleSeq vars, concepts, var_terms, ground_terms, decls;
+    for (int i = 0; i < width; i++)
+    {
+        Handle v = atomspace->add_node(VARIABLE_NODE, "$X" + std::to_string(i));
+        Handle c = atomspace->add_node(CONCEPT_NODE, "C" + std::to_string(i));
+        vars.push_back(v);
+        concepts.push_back(c);
+        var_terms.push_back(atomspace->add_link(INHERITANCE_LINK, v, c));
+        ground_terms.push_back(atomspace->add_link(INHERITANCE_LINK, c, c));
+        decls.push_back(atomspace->add_link(TYPED_VARIABLE_LINK, v, ct));
+    }
+    Handle vardecl = atomspace->add_link(VARIABLE_LIST, decls);
+
+    // Flat terms, one variable per argument.
+    compare("ordered",
+            atomspace->add_link(LIST_LINK, var_terms),
+            atomspace->add_link(LIST_LINK, ground_terms));
+    compare("ordered, typed",
+            atomspace->add_link(LIST_LINK, var_terms),
+            atomspace->add_link(LIST_LINK, ground_terms),
+            vardecl);
+
+    // Variables shared across arguments, chained two by two.
+    HandleSeq chain_lhs, chain_rhs;
+    for (int i = 0; i + 1 < width; i++)
+    {
+        chain_lhs.push_back(atomspace->add_link(LIST_LINK, vars[i], vars[i+1]));
+        chain_rhs.push_back(atomspace->add_link(LIST_LINK,
+            vars[i+1], i + 2 < width ? vars[i+2] : concepts[0]));
+    }
+    compare("shared variables",
+            atomspace->add_link(LIST_LINK, chain_lhs),
+            atomspace->add_link(LIST_LINK, chain_rhs));
+
+    // Unordered terms, where only one permutation matches.
+    compare("unordered",
+            atomspace->add_link(AND_LINK, var_terms),
+            atomspace->add_link(AND_LINK, ground_terms));
+
+    return 0;
+}
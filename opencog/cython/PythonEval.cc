@@ -23,6 +23,7 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <climits>
 #include <dlfcn.h>
 
 #include <boost/filesystem/operations.hpp>
@@ -59,7 +60,7 @@ const int MISSING_FUNC_CODE = -1;
 // The Python functions can't take const flags.
 static bool already_initialized = false;
 static bool initialized_outside_opencog = false;
-std::recursive_mutex PythonEval::_mtx;
+thread_local AtomSpace* PythonEval::_thread_as = nullptr;
 
 /*
  * @todo When can we remove the singleton instance? Answer: not sure.
@@ -370,6 +371,9 @@ PythonEval::PythonEval(AtomSpace* atomspace)
     _atomspace = atomspace;
     _paren_count = 0;
 
+    _func_gen = 0;
+    _func_cache_gen = 0;
+
     // Initialize Python objects and imports.
     //
     // Strange but true: one can use the atomspace, and put atoms
@@ -401,15 +405,32 @@ PythonEval::~PythonEval()
     Py_DECREF(_pySysPath);
     Py_DECREF(_pyRootModule);
 
+    clear_func_cache();
+    for (auto& entry : _py_atomspaces)
+        Py_XDECREF(entry.second);
+    _py_atomspaces.clear();
+
     // Release the GIL. No Python API allowed beyond this point.
     PyGILState_Release(gstate);
 }
 
+/// Drop all cached user functions. Caller must hold the GIL.
+void PythonEval::clear_func_cache(void)
+{
+    for (auto& entry : _func_cache)
+        Py_DECREF(entry.second.func);
+    _func_cache.clear();
+    _func_cache_gen = _func_gen;
+}
+
 /**
 * Use a singleton instance to avoid initializing python interpreter twice.
 */
 void PythonEval::create_singleton_instance(AtomSpace* atomspace)
 {
+    // Threads may race to be the first user of python.
+    static std::mutex create_mtx;
+    std::lock_guard<std::mutex> lck(create_mtx);
     if (singletonInstance) return;
 
     // Create the single instance of a PythonEval object.
@@ -635,6 +656,9 @@ void PythonEval::execute_string(const char* command)
     // PyString_AsString to print it gives "None" in all situations.
     // Because of this, I don't know how to write a valid command
     // interpreter for the python shell ...
+    // The command may (re-)define functions.
+    _func_gen++;
+
     PyObject* pyRootDictionary = PyModule_GetDict(_pyRootModule);
     PyObject* pyResult = PyRun_StringFlags(command,
             Py_file_input, pyRootDictionary, pyRootDictionary,
@@ -705,70 +729,135 @@ PyObject* PythonEval::module_for_function(const std::string& moduleFunction,
 }
 
 /**
- * Call the user defined function with the arguments passed in the
- * ListLink handle 'arguments'.
- *
- * On error throws an exception.
+ * Look up the user defined function, returning a new reference to it,
+ * and its expected argument count. The caller must hold the GIL; on
+ * error, the GIL is released and an exception is thrown.
  */
-PyObject* PythonEval::call_user_function(const std::string& moduleFunction,
-                                         Handle arguments)
+PyObject* PythonEval::find_user_function(const std::string& moduleFunction,
+                                         int& expectedArgumentCount,
+                                         PyGILState_STATE gstate)
 {
-    std::lock_guard<std::recursive_mutex> lck(_mtx);
+    if (_func_cache_gen != _func_gen)
+        clear_func_cache();
 
-    // Grab the GIL.
-    PyGILState_STATE gstate = PyGILState_Ensure();
+    PyObject* pyUserFunc;
+    auto cached = _func_cache.find(moduleFunction);
+    if (_func_cache.end() != cached)
+    {
+        pyUserFunc = cached->second.func;
+        expectedArgumentCount = cached->second.nargs;
+    }
+    else
+    {
+        // Get the module and stripped function name.
+        std::string functionName;
+        PyObject* pyModule = this->module_for_function(moduleFunction, functionName);
 
-    // Get the module and stripped function name.
-    std::string functionName;
-    PyObject* pyModule = this->module_for_function(moduleFunction, functionName);
+        // If we can't find that module then throw an exception.
+        if (!pyModule) {
+            PyGILState_Release(gstate);
+            logger().warn("Python module for '%s' not found!", moduleFunction.c_str());
+            throw RuntimeException(TRACE_INFO,
+                "Python module for '%s' not found!",
+                moduleFunction.c_str());
+        }
 
-    // If we can't find that module then throw an exception.
-    if (!pyModule) {
-        PyGILState_Release(gstate);
-        logger().warn("Python module for '%s' not found!", moduleFunction.c_str());
-        throw RuntimeException(TRACE_INFO,
-            "Python module for '%s' not found!",
-            moduleFunction.c_str());
-    }
+        // Get a reference to the user function.
+        PyObject* pyDict = PyModule_GetDict(pyModule);
+        pyUserFunc = PyDict_GetItemString(pyDict, functionName.c_str());
 
-    // Get a reference to the user function.
-    PyObject* pyDict = PyModule_GetDict(pyModule);
-    PyObject* pyUserFunc = PyDict_GetItemString(pyDict, functionName.c_str());
+        // PyModule_GetDict returns a borrowed reference, so don't do this:
+        // Py_DECREF(pyDict);
 
-    // PyModule_GetDict returns a borrowed reference, so don't do this:
-    // Py_DECREF(pyDict);
+        // If we can't find that function then throw an exception.
+        if (!pyUserFunc) {
+            PyGILState_Release(gstate);
+            throw RuntimeException(TRACE_INFO,
+                "Python function '%s' not found!",
+                moduleFunction.c_str());
+        }
 
-    // If we can't find that function then throw an exception.
-    if (!pyUserFunc) {
-        PyGILState_Release(gstate);
-        throw RuntimeException(TRACE_INFO,
-            "Python function '%s' not found!",
-            moduleFunction.c_str());
+        // Make sure the function is callable.
+        if (!PyCallable_Check(pyUserFunc)) {
+            PyGILState_Release(gstate);
+            throw RuntimeException(TRACE_INFO,
+                "Python function '%s' not callable!", moduleFunction.c_str());
+        }
+
+        // Get the expected argument count.
+        expectedArgumentCount = this->argument_count(pyUserFunc);
+        if (expectedArgumentCount == MISSING_FUNC_CODE) {
+            PyGILState_Release(gstate);
+            throw RuntimeException(TRACE_INFO,
+                "Python function '%s' error missing 'func_code'!",
+                moduleFunction.c_str());
+        }
+
+        // The cache holds its own reference to the function.
+        Py_INCREF(pyUserFunc);
+        _func_cache[moduleFunction] = {pyUserFunc, expectedArgumentCount};
     }
 
-    // Promote the borrowed reference for pyUserFunc since it will
-    // be passed to a Python C API function later that "steals" it.
+    // Hold a reference for the duration of the call: the function
+    // might run code that flushes the cache.
     Py_INCREF(pyUserFunc);
+    return pyUserFunc;
+}
 
-    // Make sure the function is callable.
-    if (!PyCallable_Check(pyUserFunc)) {
-        Py_DECREF(pyUserFunc);
-        PyGILState_Release(gstate);
-        throw RuntimeException(TRACE_INFO,
-            "Python function '%s' not callable!", moduleFunction.c_str());
+/**
+ * Return a new reference to the python wrapper for this thread's
+ * current atomspace. Caller must hold the GIL.
+ */
+PyObject* PythonEval::current_atomspace_py_object(void)
+{
+    // Keep only a handful of wrappers; transient atomspaces come and go,
+    // and the wrappers of those that are gone are only dropped here.
+    static const size_t MAX_PY_ATOMSPACES = 16;
+
+    AtomSpace* as = current_atomspace();
+    // A null atomspace is allowed; it gets a key of its own.
+    UUID id = as ? as->get_atomtable().get_uuid() : ULONG_MAX;
+    PyObject* pyAtomSpace;
+    auto it = _py_atomspaces.find(id);
+    if (_py_atomspaces.end() != it)
+        pyAtomSpace = it->second;
+    else
+    {
+        if (MAX_PY_ATOMSPACES <= _py_atomspaces.size())
+        {
+            for (auto& entry : _py_atomspaces)
+                Py_XDECREF(entry.second);
+            _py_atomspaces.clear();
+        }
+        pyAtomSpace = this->atomspace_py_object(as);
+        _py_atomspaces[id] = pyAtomSpace;
     }
 
-    // Get the expected argument count.
-    int expectedArgumentCount = this->argument_count(pyUserFunc);
-    if (expectedArgumentCount == MISSING_FUNC_CODE) {
-        PyGILState_Release(gstate);
-        throw RuntimeException(TRACE_INFO,
-            "Python function '%s' error missing 'func_code'!",
-            moduleFunction.c_str());
-    }
+    // Another thread may flush the cache while python runs the
+    // user function, so the caller gets its own reference.
+    Py_XINCREF(pyAtomSpace);
+    return pyAtomSpace;
+}
+
+/**
+ * Call the user defined function with the arguments passed in the
+ * ListLink handle 'arguments'.
+ *
+ * On error throws an exception.
+ */
+PyObject* PythonEval::call_user_function(const std::string& moduleFunction,
+                                         Handle arguments)
+{
+    // Grab the GIL.
+    PyGILState_STATE gstate = PyGILState_Ensure();
+
+    int expectedArgumentCount;
+    PyObject* pyUserFunc = find_user_function(moduleFunction,
+                                              expectedArgumentCount, gstate);
 
     // Get the actual argument count, passed in the ListLink.
     if (arguments->getType() != LIST_LINK) {
+        Py_DECREF(pyUserFunc);
         PyGILState_Release(gstate);
         throw RuntimeException(TRACE_INFO,
             "Expecting arguments to be a ListLink!");
@@ -777,6 +866,7 @@ PyObject* PythonEval::call_user_function(const std::string& moduleFunction,
     // Now make sure the expected count matches the actual argument count.
     int actualArgumentCount = arguments->getArity();
     if (expectedArgumentCount != actualArgumentCount) {
+        Py_DECREF(pyUserFunc);
         PyGILState_Release(gstate);
         throw RuntimeException(TRACE_INFO,
             "Python function '%s' which expects '%d arguments,"
@@ -787,7 +877,7 @@ PyObject* PythonEval::call_user_function(const std::string& moduleFunction,
     // Create the Python tuple for the function call with python
     // atoms for each of the atoms in the link arguments.
     PyObject* pyArguments = PyTuple_New(actualArgumentCount);
-    PyObject* pyAtomSpace = this->atomspace_py_object(_atomspace);
+    PyObject* pyAtomSpace = current_atomspace_py_object();
     const HandleSeq& argumentHandles = arguments->getOutgoingSet();
     int tupleItem = 0;
     for (const Handle& h: argumentHandles)
@@ -803,7 +893,7 @@ PyObject* PythonEval::call_user_function(const std::string& moduleFunction,
 
         ++tupleItem;
     }
-    Py_DECREF(pyAtomSpace);
+    Py_XDECREF(pyAtomSpace);
 
     // Execute the user function and store its return value.
     PyObject* pyReturnValue = PyObject_CallObject(pyUserFunc, pyArguments);
@@ -835,8 +925,7 @@ PyObject* PythonEval::call_user_function(const std::string& moduleFunction,
 
 Handle PythonEval::apply(AtomSpace* as, const std::string& func, Handle varargs)
 {
-    std::lock_guard<std::recursive_mutex> lck(_mtx);
-    RAII raii(this, as);
+    RAII raii(as);
 
     // Get the atom object returned by this user function.
     PyObject* pyReturnAtom = this->call_user_function(func, varargs);
@@ -887,8 +976,7 @@ Handle PythonEval::apply(AtomSpace* as, const std::string& func, Handle varargs)
  */
 TruthValuePtr PythonEval::apply_tv(AtomSpace *as, const std::string& func, Handle varargs)
 {
-    std::lock_guard<std::recursive_mutex> lck(_mtx);
-    RAII raii(this, as);
+    RAII raii(as);
 
     // Get the python truth value object returned by this user function.
     PyObject *pyTruthValue = call_user_function(func, varargs);
@@ -935,6 +1023,115 @@ TruthValuePtr PythonEval::apply_tv(AtomSpace *as, const std::string& func, Handl
     return tvp;
 }
 
+/**
+ * Apply the user function once, to a whole batch of argument lists,
+ * returning one truth value per list.
+ *
+ * Each of arglists is a ListLink of the arity that the function
+ * expects.  Each argument of the function is passed a python list:
+ * argument k holds the k'th atom of every ListLink, in order.  Thus,
+ * for ListLinks (A B) and (C D), the call is func([A, C], [B, D]).
+ * The function must return a sequence of TruthValues, one per ListLink.
+ */
+std::vector<TruthValuePtr> PythonEval::apply_tv_batch(AtomSpace *as,
+                                                      const std::string& func,
+                                                      const HandleSeq& arglists)
+{
+    std::vector<TruthValuePtr> tvs;
+    if (arglists.empty()) return tvs;
+
+    RAII raii(as);
+
+    // Grab the GIL.
+    PyGILState_STATE gstate = PyGILState_Ensure();
+
+    int nargs;
+    PyObject* pyUserFunc = find_user_function(func, nargs, gstate);
+
+    // As in SchemeEval::apply_tv_batch(), an argument list that is not
+    // a ListLink is a single argument.
+    for (const Handle& al : arglists)
+    {
+        int arity = LIST_LINK == al->getType() ? al->getArity() : 1;
+        if (nargs != arity) {
+            Py_DECREF(pyUserFunc);
+            PyGILState_Release(gstate);
+            throw RuntimeException(TRACE_INFO,
+                "Python function '%s' expects %d arguments, but was "
+                "given %d in the batch!", func.c_str(), nargs, arity);
+        }
+    }
+
+    // Transpose the argument lists into columns.
+    Py_ssize_t batch = arglists.size();
+    PyObject* pyAtomSpace = current_atomspace_py_object();
+    PyObject* pyArguments = PyTuple_New(nargs);
+    for (int k = 0; k < nargs; k++)
+    {
+        PyObject* pyColumn = PyList_New(batch);
+        for (Py_ssize_t i = 0; i < batch; i++)
+        {
+            const Handle& al = arglists[i];
+            const Handle& h = LIST_LINK == al->getType() ?
+                al->getOutgoingSet()[k] : al;
+            long int patom = (long int) &h;
+            PyList_SET_ITEM(pyColumn, i, py_atom(patom, pyAtomSpace));
+        }
+        PyTuple_SetItem(pyArguments, k, pyColumn);
+    }
+    Py_XDECREF(pyAtomSpace);
+
+    PyObject* pyReturnValue = PyObject_CallObject(pyUserFunc, pyArguments);
+    Py_DECREF(pyUserFunc);
+    Py_DECREF(pyArguments);
+
+    if (PyErr_Occurred()) {
+        Py_XDECREF(pyReturnValue);
+        std::string errorString;
+        this->build_python_error_message(func.c_str(), errorString);
+        PyGILState_Release(gstate);
+        throw RuntimeException(TRACE_INFO, "%s", errorString.c_str());
+    }
+
+    PyObject* pySeq = nullptr;
+    if (pyReturnValue)
+        pySeq = PySequence_Fast(pyReturnValue,
+                                "vectorised function must return a sequence");
+    Py_XDECREF(pyReturnValue);
+
+    bool ok = pySeq and PySequence_Fast_GET_SIZE(pySeq) == batch;
+    tvs.reserve(batch);
+    for (Py_ssize_t i = 0; ok and i < batch; i++)
+    {
+        PyObject* pyTV = PySequence_Fast_GET_ITEM(pySeq, i);
+        PyObject* pyTVPtrPtr = PyObject_CallMethod(pyTV,
+                (char*) "truth_value_ptr_object", NULL);
+        if (PyErr_Occurred() or nullptr == pyTVPtrPtr) {
+            Py_XDECREF(pyTVPtrPtr);
+            ok = false;
+            break;
+        }
+        // See apply_tv() for why this is a pointer to the shared_ptr.
+        TruthValuePtr* tvpPtr = static_cast<TruthValuePtr*>
+                (PyLong_AsVoidPtr(pyTVPtrPtr));
+        tvs.emplace_back(*tvpPtr);
+        Py_DECREF(pyTVPtrPtr);
+    }
+    Py_XDECREF(pySeq);
+
+    if (not ok) {
+        PyErr_Clear();
+        PyGILState_Release(gstate);
+        throw RuntimeException(TRACE_INFO,
+            "Python function '%s' did not return %zd TruthValues!",
+            func.c_str(), batch);
+    }
+
+    // Release the GIL. No Python API allowed beyond this point.
+    PyGILState_Release(gstate);
+    return tvs;
+}
+
 /**
  * Call the user defined function with the provide atomspace argument.
  * This is a cut-n-paste of PythonEval::call_user_function but with
@@ -945,8 +1142,6 @@ TruthValuePtr PythonEval::apply_tv(AtomSpace *as, const std::string& func, Handl
 void PythonEval::apply_as(const std::string& moduleFunction,
                           AtomSpace* as_argument)
 {
-    std::lock_guard<std::recursive_mutex> lck(_mtx);
-
     PyObject *pyError, *pyModule, *pyUserFunc;
     PyObject *pyDict;
     std::string functionName;
@@ -1050,8 +1245,6 @@ void PythonEval::apply_as(const std::string& moduleFunction,
 
 std::string PythonEval::apply_script(const std::string& script)
 {
-    std::lock_guard<std::recursive_mutex> lck(_mtx);
-
     // Grab the GIL
     PyGILState_STATE gstate = PyGILState_Ensure();
 
@@ -1121,6 +1314,9 @@ void PythonEval::import_module(const boost::filesystem::path &file,
 
     logger().info("    importing Python module: " + moduleName);
 
+    // The module may replace functions that are cached.
+    _func_gen++;
+
     // Import the entire module into the current Python environment.
     PyObject* pyModule = PyImport_ImportModuleLevel((char*) moduleName.c_str(),
             _pyGlobal, _pyLocal, pyFromList,
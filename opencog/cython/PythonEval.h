@@ -40,10 +40,12 @@
 
 #include "PyIncludeWrapper.h"
 
+#include <atomic>
 #include <condition_variable>
 #include <map>
 #include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <boost/filesystem/operations.hpp>
@@ -61,6 +63,11 @@ class AtomSpace;
  * Singleton class used to initialize python interpreter in the main thread.
  * It also provides some handy functions, such as getPyAtomspace. These helper
  * functions may need python GIL and you should do this manually.
+ *
+ * The apply() methods may be called from many threads at once, each with
+ * its own atomspace; the only serialization is the GIL, which python
+ * itself releases periodically, and which the pattern-matcher entry
+ * points in the cython bindings release while they run.
  */
 class PythonEval : public GenericEval
 {
@@ -76,6 +83,9 @@ class PythonEval : public GenericEval
         void add_modules_from_abspath(std::string path);
 
         // Python utility functions
+        PyObject* find_user_function(const std::string& func, int& nargs,
+                                     PyGILState_STATE);
+        PyObject* current_atomspace_py_object(void);
         PyObject* call_user_function(const std::string& func,
                                      Handle varargs);
         void build_python_error_message(const char* function_name,
@@ -90,31 +100,27 @@ class PythonEval : public GenericEval
 
         static PythonEval* singletonInstance;
 
+        // The atomspace given at construction; it is the ATOMSPACE
+        // seen by python modules.
         AtomSpace* _atomspace;
+
+        // The atomspace that user functions are currently being applied
+        // in, for this thread. Each thread has its own, so that threads
+        // working in different atomspaces need not exclude one another;
+        // only the GIL is needed.  Null means the default, above.
+        static thread_local AtomSpace* _thread_as;
+        AtomSpace* current_atomspace(void) const
+            { return _thread_as ? _thread_as : _atomspace; }
+
         // Resource Acquisition is Allocation, for the current AtomSpace.
         // If anything throws an exception, then dtor runs and restores
-        // the old atomspace.
+        // the old atomspace. Nests, for recursive calls.
         struct RAII {
-            RAII(PythonEval* pev, AtomSpace* as) : _pev(pev)
-               { _save_as = pev->_atomspace; pev->_atomspace = as; }
-            ~RAII() {_pev->_atomspace = _save_as; }
+            RAII(AtomSpace* as) : _save_as(_thread_as) { _thread_as = as; }
+            ~RAII() { _thread_as = _save_as; }
             AtomSpace* _save_as;
-            PythonEval* _pev;
         };
 
-        // Single, global mutex for serializing access to the atomspace.
-        // The singleton-instance design of this class forces us to
-        // serialize access (the GIL is not enough), because there is
-        // no way to guarantee that python won't accidentally be called
-        // from multiple threads.  That's because the EvaluationLink
-        // is called from scheme and from the pattern matcher, and its
-        // unknown how many threads those things might be running in.
-        // The lock is recursive, because we may need to use multiple
-        // different atomspaces with the evaluator, in some nested
-        // fashion. So this lock prevents other threads from using the
-        // wrong atomspace in some other thread.  Quite unfortunate.
-        static std::recursive_mutex _mtx;
-
         // Computed results are typically polled in a distinct thread.
         bool _eval_done;
         std::mutex _poll_mtx;
@@ -129,6 +135,28 @@ class PythonEval : public GenericEval
 
         std::map <std::string, PyObject*> _modules;
 
+        // Resolved user functions, by "module.function" name, so that
+        // repeated calls skip the module and dictionary lookups, and
+        // the argument-count introspection. Running python code, or
+        // importing modules, may redefine functions; this bumps
+        // _func_gen, and the cache is flushed on its next use.
+        struct UserFunction {
+            PyObject* func;
+            int nargs;
+        };
+        std::unordered_map<std::string, UserFunction> _func_cache;
+        std::atomic<unsigned long> _func_gen;
+        unsigned long _func_cache_gen;
+        void clear_func_cache(void);
+
+        // The python wrappers for the atomspaces passed to user
+        // functions; rebuilding one for every call is costly. Keyed by
+        // the UUID of the atomtable, which unlike the address of the
+        // atomspace is never reused, so that a wrapper can never be
+        // handed out for an atomspace other than its own. Guarded by
+        // the GIL.
+        std::unordered_map<UUID, PyObject*> _py_atomspaces;
+
         std::string _result;
         int _paren_count;
         void eval_expr_line(const std::string&);
@@ -182,6 +210,17 @@ class PythonEval : public GenericEval
          */
         TruthValuePtr apply_tv(AtomSpace*, const std::string& func, Handle varargs);
 
+        /**
+         * Calls the Python function passed in `func` once, for a whole
+         * batch of argument ListLinks, returning one TruthValuePtr per
+         * ListLink.  Each function argument is passed as a python list,
+         * holding that argument for every ListLink in the batch.  An
+         * atom other than a ListLink is taken as a single argument.
+         */
+        std::vector<TruthValuePtr> apply_tv_batch(AtomSpace*,
+                                                  const std::string& func,
+                                                  const HandleSeq& arglists);
+
         /**
          * Calls the Python function passed in `func`, passing it
          * the AtomSpace as an argument, returning void.
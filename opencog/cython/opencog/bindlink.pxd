@@ -7,7 +7,7 @@ cdef extern from "opencog/cython/opencog/BindlinkStub.h" namespace "opencog":
     #   Handle stub_bindlink(AtomSpace*, Handle);
     #
     cdef cHandle c_stub_bindlink "stub_bindlink" (cAtomSpace*, cHandle)
-    cdef cHandle c_execute_atom "do_execute"(cAtomSpace*, cHandle)
+    cdef cHandle c_execute_atom "do_execute"(cAtomSpace*, cHandle) nogil except +
 
 
 cdef extern from "opencog/query/BindLinkAPI.h" namespace "opencog":
@@ -17,10 +17,13 @@ cdef extern from "opencog/query/BindLinkAPI.h" namespace "opencog":
     #   TruthValuePtr satisfaction_link(AtomSpace*, Handle);
     #   Handle satisfying_set(AtomSpace*, Handle, size_t);
     #
-    cdef cHandle c_bindlink "bindlink" (cAtomSpace*, cHandle, cSize)
-    cdef cHandle c_af_bindlink "af_bindlink" (cAtomSpace*, cHandle)
-    cdef tv_ptr c_satisfaction_link "satisfaction_link" (cAtomSpace*, cHandle)
-    cdef cHandle c_satisfying_set "satisfying_set" (cAtomSpace*, cHandle, cSize)
+    # These run the pattern matcher, and are called without the GIL,
+    # so that other python threads can run meanwhile.
+    #
+    cdef cHandle c_bindlink "bindlink" (cAtomSpace*, cHandle, cSize) nogil except +
+    cdef cHandle c_af_bindlink "af_bindlink" (cAtomSpace*, cHandle) nogil except +
+    cdef tv_ptr c_satisfaction_link "satisfaction_link" (cAtomSpace*, cHandle) nogil except +
+    cdef cHandle c_satisfying_set "satisfying_set" (cAtomSpace*, cHandle, cSize) nogil except +
 
 cdef extern from "opencog/atoms/execution/EvaluationLink.h" namespace "opencog":
-    tv_ptr c_evaluate_atom "opencog::EvaluationLink::do_evaluate"(cAtomSpace*, cHandle)
+    tv_ptr c_evaluate_atom "opencog::EvaluationLink::do_evaluate"(cAtomSpace*, cHandle) nogil except +
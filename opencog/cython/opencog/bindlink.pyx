@@ -14,15 +14,21 @@ def stub_bindlink(AtomSpace atomspace, Atom atom):
 
 def bindlink(AtomSpace atomspace, Atom atom):
     if atom == None: raise ValueError("bindlink atom is: None")
-    cdef cHandle c_result = c_bindlink(atomspace.atomspace,
-                                       deref(atom.handle), -1)
+    cdef cAtomSpace* c_as = atomspace.atomspace
+    cdef cHandle c_atom = deref(atom.handle)
+    cdef cHandle c_result
+    with nogil:
+        c_result = c_bindlink(c_as, c_atom, -1)
     cdef Atom result = Atom(void_from_candle(c_result), atomspace)
     return result
 
 def single_bindlink(AtomSpace atomspace, Atom atom):
     if atom == None: raise ValueError("single_bindlink atom is: None")
-    cdef cHandle c_result = c_bindlink(atomspace.atomspace,
-                                       deref(atom.handle), 1)
+    cdef cAtomSpace* c_as = atomspace.atomspace
+    cdef cHandle c_atom = deref(atom.handle)
+    cdef cHandle c_result
+    with nogil:
+        c_result = c_bindlink(c_as, c_atom, 1)
     cdef Atom result = Atom(void_from_candle(c_result), atomspace)
     return result
 
@@ -30,22 +36,32 @@ def first_n_bindlink(AtomSpace atomspace, Atom atom, max_results):
     if atom == None: raise ValueError("first_n_bindlink atom is: None")
     if not isinstance(max_results, int):
         raise ValueError("first_n_bindlink max_results is not integer")
-    cdef cHandle c_result = c_bindlink(atomspace.atomspace,
-                                       deref(atom.handle), max_results)
+    cdef cAtomSpace* c_as = atomspace.atomspace
+    cdef cHandle c_atom = deref(atom.handle)
+    cdef cSize c_max = max_results
+    cdef cHandle c_result
+    with nogil:
+        c_result = c_bindlink(c_as, c_atom, c_max)
     cdef Atom result = Atom(void_from_candle(c_result), atomspace)
     return result
 
 def af_bindlink(AtomSpace atomspace, Atom atom):
     if atom == None: raise ValueError("af_bindlink atom is: None")
-    cdef cHandle c_result = c_af_bindlink(atomspace.atomspace, 
-                                          deref(atom.handle))
+    cdef cAtomSpace* c_as = atomspace.atomspace
+    cdef cHandle c_atom = deref(atom.handle)
+    cdef cHandle c_result
+    with nogil:
+        c_result = c_af_bindlink(c_as, c_atom)
     cdef Atom result = Atom(void_from_candle(c_result), atomspace)
     return result
 
 def satisfaction_link(AtomSpace atomspace, Atom atom):
     if atom == None: raise ValueError("satisfaction_link atom is: None")
-    cdef tv_ptr result_tv_ptr = c_satisfaction_link(atomspace.atomspace,
-                                                 deref(atom.handle))
+    cdef cAtomSpace* c_as = atomspace.atomspace
+    cdef cHandle c_atom = deref(atom.handle)
+    cdef tv_ptr result_tv_ptr
+    with nogil:
+        result_tv_ptr = c_satisfaction_link(c_as, c_atom)
     cdef cTruthValue* result_tv = result_tv_ptr.get()
     cdef strength_t strength = deref(result_tv).getMean()
     cdef strength_t confidence = deref(result_tv).getConfidence()
@@ -53,15 +69,21 @@ def satisfaction_link(AtomSpace atomspace, Atom atom):
 
 def satisfying_set(AtomSpace atomspace, Atom atom):
     if atom == None: raise ValueError("satisfying_set atom is: None")
-    cdef cHandle c_result = c_satisfying_set(atomspace.atomspace,
-                                             deref(atom.handle), -1)
+    cdef cAtomSpace* c_as = atomspace.atomspace
+    cdef cHandle c_atom = deref(atom.handle)
+    cdef cHandle c_result
+    with nogil:
+        c_result = c_satisfying_set(c_as, c_atom, -1)
     cdef Atom result = Atom(void_from_candle(c_result), atomspace)
     return result
 
 def satisfying_element(AtomSpace atomspace, Atom atom):
     if atom == None: raise ValueError("satisfying_element atom is: None")
-    cdef cHandle c_result = c_satisfying_set(atomspace.atomspace,
-                                             deref(atom.handle), 1)
+    cdef cAtomSpace* c_as = atomspace.atomspace
+    cdef cHandle c_atom = deref(atom.handle)
+    cdef cHandle c_result
+    with nogil:
+        c_result = c_satisfying_set(c_as, c_atom, 1)
     cdef Atom result = Atom(void_from_candle(c_result), atomspace)
     return result
 
@@ -69,21 +91,31 @@ def first_n_satisfying_set(AtomSpace atomspace, Atom atom, max_results):
     if atom == None: raise ValueError("first_n_satisfying_set atom is: None")
     if not isinstance(max_results, int):
         raise ValueError("first_n_satisfying_set max_results is not integer")
-    cdef cHandle c_result = c_satisfying_set(atomspace.atomspace,
-                                             deref(atom.handle), max_results)
+    cdef cAtomSpace* c_as = atomspace.atomspace
+    cdef cHandle c_atom = deref(atom.handle)
+    cdef cSize c_max = max_results
+    cdef cHandle c_result
+    with nogil:
+        c_result = c_satisfying_set(c_as, c_atom, c_max)
     cdef Atom result = Atom(void_from_candle(c_result), atomspace)
     return result
 
 def execute_atom(AtomSpace atomspace, Atom atom):
     if atom == None: raise ValueError("execute_atom atom is: None")
-    cdef cHandle c_result = c_execute_atom(atomspace.atomspace,
-                                           deref(atom.handle))
+    cdef cAtomSpace* c_as = atomspace.atomspace
+    cdef cHandle c_atom = deref(atom.handle)
+    cdef cHandle c_result
+    with nogil:
+        c_result = c_execute_atom(c_as, c_atom)
     return Atom(void_from_candle(c_result), atomspace)
 
 def evaluate_atom(AtomSpace atomspace, Atom atom):
     if atom == None: raise ValueError("evaluate_atom atom is: None")
-    cdef tv_ptr result_tv_ptr = c_evaluate_atom(atomspace.atomspace,
-                                                deref(atom.handle))
+    cdef cAtomSpace* c_as = atomspace.atomspace
+    cdef cHandle c_atom = deref(atom.handle)
+    cdef tv_ptr result_tv_ptr
+    with nogil:
+        result_tv_ptr = c_evaluate_atom(c_as, c_atom)
     cdef cTruthValue* result_tv = result_tv_ptr.get()
     cdef strength_t strength = deref(result_tv).getMean()
     cdef strength_t confidence = deref(result_tv).getConfidence()
@@ -36,6 +36,10 @@ using namespace opencog;
 
 std::mutex init_mtx;
 
+// The interrupt flag of the evaluator running in this thread, if
+// it can be interrupted.
+static thread_local std::atomic_bool* tl_interrupted = nullptr;
+
 /**
  * This init is called once for every time that this class
  * is instantiated -- i.e. it is a per-instance initializer.
@@ -53,6 +57,12 @@ void SchemeEval::init(void)
 	_in_shell = false;
 	_in_eval = false;
 	_eval_thread = SCM_EOL;
+	_interrupted = false;
+	_generation = 0;
+	_control = nullptr;
+	_control_irq = 0;
+	_saved_eval_thread = SCM_EOL;
+	_saved_interrupted = nullptr;
 
 	// User error and crash management
 	_error_string = SCM_EOL;
@@ -62,6 +72,7 @@ void SchemeEval::init(void)
 	_captured_stack = scm_gc_protect_object(_captured_stack);
 
 	_pexpr = NULL;
+	_batch_args = NULL;
 	_eval_done = false;
 	_poll_done = false;
 
@@ -138,7 +149,11 @@ void SchemeEval::redirect_output(void)
 
 	scm_set_current_output_port(_outport);
 
+	std::lock_guard<std::mutex> lock(_interrupt_mtx);
+	_generation++;
+	_interrupted = false;
 	_eval_thread = scm_current_thread();
+	tl_interrupted = &_interrupted;
 }
 
 void SchemeEval::restore_output(void)
@@ -151,7 +166,10 @@ void SchemeEval::restore_output(void)
 		scm_set_current_output_port(_saved_outport);
 	scm_gc_unprotect_object(_saved_outport);
 
+	std::lock_guard<std::mutex> lock(_interrupt_mtx);
+	_generation++;
 	_eval_thread = SCM_EOL;
+	tl_interrupted = nullptr;
 }
 
 /// Discard all chars in the outport.
@@ -186,6 +204,7 @@ void SchemeEval::finish(void)
 
 	scm_gc_unprotect_object(_error_string);
 	scm_gc_unprotect_object(_captured_stack);
+	clear_procs();
 
 	// Force garbage collection
 	scm_gc();
@@ -264,16 +283,31 @@ static void * do_bogus_scm(void *p)
  * FWIW, the unit test MultiThreadUTest tests atom creation in multiple
  * threads. As of 29 Nov 2014, it passes, for me, using guile-2.0.9
  * which is the stock version of guile in Mint Qiana 17 aka Ubuntu 14.04
+ *
+ * Since the bug only bites top-level defines, the lock is lifted once
+ * the user calls SchemeEval::enable_threads(), after loading scripts.
  */
-static pthread_mutex_t serialize_lock;
-static pthread_key_t ser_key = 0;
+static std::mutex serialize_lock;
+
+// Nesting depth of thread_lock() in this thread, and whether the
+// outermost call actually took the lock.
+static thread_local int ser_depth = 0;
+static thread_local bool ser_held = false;
 #endif /* WORK_AROUND_GUILE_THREADING_BUG */
 
+static std::atomic_bool serialize_evals(true);
+
 // This will throw an exception, when it is called.  It is used
 // to interrupt infinite loops or long-running processes, when the
-// user hits control-C at a telnet prompt.
+// user hits control-C at a telnet prompt, or when an ExecControl is
+// cancelled.
 static SCM throw_except(void)
 {
+	// Guile runs the async at the next safe point, which may come
+	// after the evaluation it was aimed at is over; drop it then.
+	if (nullptr == tl_interrupted or not tl_interrupted->exchange(false))
+		return SCM_UNSPECIFIED;
+
 	scm_throw(
 		scm_from_utf8_symbol("user-interrupt"),
 		scm_list_2(
@@ -303,11 +337,6 @@ static void init_only_once(void)
 {
 	if (eval_is_inited.test_and_set()) return;
 
-#ifdef WORK_AROUND_GUILE_THREADING_BUG
-	pthread_mutex_init(&serialize_lock, NULL);
-	pthread_key_create(&ser_key, NULL);
-	pthread_setspecific(ser_key, (const void *) 0x0);
-#endif /* WORK_AROUND_GUILE_THREADING_BUG */
 #ifdef WORK_AROUND_GUILE_185_BUG
 	scm_with_guile(do_bogus_scm, NULL);
 	guile_user_module = scm_current_module();
@@ -324,27 +353,44 @@ static void init_only_once(void)
  */
 void SchemeEval::thread_lock(void)
 {
-	long cnt = (long) pthread_getspecific(ser_key);
-	if (0 >= cnt)
+	if (0 == ser_depth++)
 	{
-		pthread_mutex_lock(&serialize_lock);
+		ser_held = serialize_evals;
+		if (ser_held) serialize_lock.lock();
 	}
-	cnt ++;
-	pthread_setspecific(ser_key, (const void *) cnt);
 }
 
 void SchemeEval::thread_unlock(void)
 {
-	long cnt = (long) pthread_getspecific(ser_key);
-	cnt --;
-	pthread_setspecific(ser_key, (const void *) cnt);
-	if (0 >= cnt)
+	if (0 == --ser_depth and ser_held)
 	{
-		pthread_mutex_unlock(&serialize_lock);
+		ser_held = false;
+		serialize_lock.unlock();
 	}
 }
 #endif
 
+/**
+ * Stop serializing evaluation across threads. Only old guile versions
+ * serialize at all; the lock exists to work around a bug with
+ * concurrent top-level defines, and so is not needed once all of the
+ * scripts have been loaded.  Evaluations already in progress finish
+ * under the lock.
+ */
+void SchemeEval::enable_threads(void)
+{
+	serialize_evals = false;
+}
+
+bool SchemeEval::threads_enabled(void)
+{
+#ifdef WORK_AROUND_GUILE_THREADING_BUG
+	return not serialize_evals;
+#else
+	return true;
+#endif /* WORK_AROUND_GUILE_THREADING_BUG */
+}
+
 SchemeEval::SchemeEval(AtomSpace* as)
 {
 	init_only_once();
@@ -891,19 +937,79 @@ SCM SchemeEval::do_scm_eval(SCM sexpr, SCM (*evo)(void *))
 
 void SchemeEval::interrupt(void)
 {
-	if (SCM_EOL == _eval_thread) return;
-	scm_with_guile(c_wrap_interrupt, this);
+	size_t generation;
+	{
+		std::lock_guard<std::mutex> lock(_interrupt_mtx);
+		generation = _generation;
+	}
+	interrupt(generation);
 }
 
-void * SchemeEval::c_wrap_interrupt(void* p)
+/**
+ * Interrupt the evaluation that was running when `generation` was
+ * current, if it still is.  An interrupt that comes late, after that
+ * evaluation is over, must not hit the next one.
+ */
+void SchemeEval::interrupt(size_t generation)
 {
-	SchemeEval *self = (SchemeEval *) p;
-	SCM thr = self->_eval_thread;
-	if (SCM_EOL == thr) return self;
+	SCM thr;
+	{
+		std::lock_guard<std::mutex> lock(_interrupt_mtx);
+		if (generation != _generation or SCM_EOL == _eval_thread)
+			return;
+		_interrupted = true;
+		thr = _eval_thread;
+	}
+	scm_with_guile(c_wrap_interrupt, &thr);
+}
 
+void * SchemeEval::c_wrap_interrupt(void* p)
+{
+	SCM thr = *(SCM *) p;
 	scm_system_async_mark_for_thread(throw_thunk, thr);
+	return p;
+}
 
-	return self;
+/**
+ * If the procedure about to be applied runs under an ExecControl,
+ * arrange for a cancel() to interrupt it.  Called in guile mode.
+ * Returns false if the execution is already cancelled, in which case
+ * the procedure should not be run at all.
+ */
+bool SchemeEval::watch_control(void)
+{
+	_control = ExecControl::current();
+	if (nullptr == _control) return true;
+
+	size_t generation;
+	{
+		std::lock_guard<std::mutex> lock(_interrupt_mtx);
+		_saved_eval_thread = _eval_thread;
+		_saved_interrupted = tl_interrupted;
+		generation = ++_generation;
+		_interrupted = false;
+		_eval_thread = scm_current_thread();
+		tl_interrupted = &_interrupted;
+	}
+	_control_irq = _control->add_interrupt(
+		[this, generation]() { interrupt(generation); });
+
+	// A cancel() that ran before add_interrupt() did not see us.
+	return not _control->is_cancelled();
+}
+
+void SchemeEval::unwatch_control(void)
+{
+	if (nullptr == _control) return;
+	_control->remove_interrupt(_control_irq);
+	_control = nullptr;
+
+	// A cancel() still running the interrupt now finds a later
+	// generation, and leaves the restored evaluation alone.
+	std::lock_guard<std::mutex> lock(_interrupt_mtx);
+	_generation++;
+	tl_interrupted = _saved_interrupted;
+	_eval_thread = _saved_eval_thread;
 }
 
 /* ============================================================== */
@@ -1111,6 +1217,8 @@ Handle SchemeEval::apply(const std::string &func, Handle varargs)
 #ifdef WORK_AROUND_GUILE_THREADING_BUG
 	thread_unlock();
 #endif /* WORK_AROUND_GUILE_THREADING_BUG */
+	// Report an interrupted procedure as the cancellation it was.
+	ExecControl::check_current();
 	if (eval_error())
 		throw RuntimeException(TRACE_INFO, "%s", _error_msg.c_str());
 
@@ -1120,7 +1228,9 @@ Handle SchemeEval::apply(const std::string &func, Handle varargs)
 void * SchemeEval::c_wrap_apply(void * p)
 {
 	SchemeEval *self = (SchemeEval *) p;
-	self->_hargs = self->do_apply(*self->_pexpr, self->_hargs);
+	if (self->watch_control())
+		self->_hargs = self->do_apply(*self->_pexpr, self->_hargs);
+	self->unwatch_control();
 	return self;
 }
 
@@ -1151,9 +1261,72 @@ static SCM thunk_scm_eval(void * expr)
  * atom handles. This list is unpacked, and then the fuction func
  * is applied to them. The SCM value returned by the function is returned.
  */
+static SCM thunk_scm_apply(void * expr)
+{
+	SCM svar = scm_car((SCM) expr);
+	return scm_apply_0(scm_variable_ref(svar), scm_cdr((SCM) expr));
+}
+
+/// Look up the variable that the function name is bound to, in the
+/// current module, once.  Holding on to the variable, rather than to
+/// its value, means that a later re-definition of a function defined
+/// in the module is still seen.  An imported function is different:
+/// a local definition of the same name makes a new variable, which
+/// hides it; the cached variable is checked against that.  A change
+/// of current module causes a fresh look-up.  Returns SCM_BOOL_F if
+/// the name is not bound.
+SCM SchemeEval::lookup_proc(const std::string& func)
+{
+	// Keep only so many; the names come from the atomspace, and need
+	// not be few.
+	static const size_t MAX_PROCS = 256;
+
+	SCM module = scm_current_module();
+	auto pit = _procs.find(func);
+	if (_procs.end() != pit)
+	{
+		const Proc& p = pit->second;
+		if (scm_is_eq(p.module, module) and (p.local or
+		    scm_is_false(scm_module_local_variable(module, p.sym))))
+			return p.var;
+
+		scm_gc_unprotect_object(p.module);
+		scm_gc_unprotect_object(p.sym);
+		scm_gc_unprotect_object(p.var);
+		_procs.erase(pit);
+	}
+
+	SCM sym = scm_from_utf8_symbol(func.c_str());
+	SCM svar = scm_module_variable(module, sym);
+	if (scm_is_true(svar))
+	{
+		if (MAX_PROCS <= _procs.size())
+			clear_procs();
+		bool local = scm_is_eq(svar, scm_module_local_variable(module, sym));
+		scm_gc_protect_object(module);
+		scm_gc_protect_object(sym);
+		scm_gc_protect_object(svar);
+		_procs.emplace(func, Proc{module, sym, svar, local});
+	}
+	return svar;
+}
+
+/// Drop the cached variables, and their protection from the garbage
+/// collector.  Must be called in guile mode.
+void SchemeEval::clear_procs(void)
+{
+	for (auto& pr : _procs)
+	{
+		scm_gc_unprotect_object(pr.second.module);
+		scm_gc_unprotect_object(pr.second.sym);
+		scm_gc_unprotect_object(pr.second.var);
+	}
+	_procs.clear();
+}
+
 SCM SchemeEval::do_apply_scm(const std::string& func, const Handle& varargs )
 {
-	SCM sfunc = scm_from_utf8_symbol(func.c_str());
+	SCM svar = lookup_proc(func);
 	SCM expr = SCM_EOL;
 
 	// If there were args, pass the args to the function.
@@ -1173,13 +1346,21 @@ SCM SchemeEval::do_apply_scm(const std::string& func, const Handle& varargs )
 			expr = scm_cons(sh, expr);
 		}
 	}
-	expr = scm_cons(sfunc, expr);
+
+	// If the name is not bound (yet), evaluate it the long way,
+	// so that the usual unbound-variable error gets reported.
+	if (scm_is_false(svar))
+	{
+		expr = scm_cons(scm_from_utf8_symbol(func.c_str()), expr);
+		return do_scm_eval(expr, thunk_scm_eval);
+	}
 
 	// TODO: it would be nice to pass exceptions on through, but
 	// this currently breaks unit tests.
 	// if (_in_eval)
 	//    return scm_eval(expr, scm_interaction_environment());
-	return do_scm_eval(expr, thunk_scm_eval);
+	expr = scm_cons(svar, expr);
+	return do_scm_eval(expr, thunk_scm_apply);
 }
 
 /* ============================================================== */
@@ -1222,6 +1403,7 @@ TruthValuePtr SchemeEval::apply_tv(const std::string &func, Handle varargs)
 #ifdef WORK_AROUND_GUILE_THREADING_BUG
 	thread_unlock();
 #endif /* WORK_AROUND_GUILE_THREADING_BUG */
+	ExecControl::check_current();
 	if (eval_error())
 		throw RuntimeException(TRACE_INFO, "%s", _error_msg.c_str());
 
@@ -1235,12 +1417,133 @@ TruthValuePtr SchemeEval::apply_tv(const std::string &func, Handle varargs)
 void * SchemeEval::c_wrap_apply_tv(void * p)
 {
 	SchemeEval *self = (SchemeEval *) p;
-	SCM tv_smob = self->do_apply_scm(*self->_pexpr, self->_hargs);
-	if (self->eval_error()) return self;
-	self->_tvp = SchemeSmob::to_tv(tv_smob);
+	if (self->watch_control())
+	{
+		SCM tv_smob = self->do_apply_scm(*self->_pexpr, self->_hargs);
+		if (not self->eval_error())
+			self->_tvp = SchemeSmob::to_tv(tv_smob);
+	}
+	self->unwatch_control();
 	return self;
 }
 
+/* ============================================================== */
+/**
+ * apply_tv_batch -- apply named function func, once, to a whole batch
+ * of argument lists. Return one OpenCog TruthValuePtr per list.
+ *
+ * Each of arglists is a ListLink, or a single atom, taken as a list
+ * of one; all of them must have the same arity. The function is called with that many arguments, each of
+ * which is a scheme list: argument k holds the k'th atom of every
+ * ListLink in the batch, in order. Thus, for ListLinks (A B) and (C D),
+ * the call is (func (list A C) (list B D)). The function must return
+ * a list of TruthValues, one per ListLink.
+ */
+std::vector<TruthValuePtr>
+SchemeEval::apply_tv_batch(const std::string &func, const HandleSeq& arglists)
+{
+	if (arglists.empty()) return std::vector<TruthValuePtr>();
+
+	// Validate here; no C++ exceptions can be thrown inside of guile.
+	Arity arity = LIST_LINK == arglists[0]->getType() ?
+		arglists[0]->getArity() : 1;
+	for (const Handle& al : arglists)
+	{
+		Arity ar = LIST_LINK == al->getType() ? al->getArity() : 1;
+		if (ar != arity)
+			throw RuntimeException(TRACE_INFO,
+				"Batched call to %s with mismatched argument counts %d and %d",
+				func.c_str(), arity, ar);
+	}
+
+	if (_in_eval) {
+		do_apply_tv_batch(func, arglists);
+		if (eval_error())
+			throw RuntimeException(TRACE_INFO, "%s", _error_msg.c_str());
+	}
+	else
+	{
+#ifdef WORK_AROUND_GUILE_THREADING_BUG
+		thread_lock();
+#endif /* WORK_AROUND_GUILE_THREADING_BUG */
+
+		_pexpr = &func;
+		_batch_args = &arglists;
+		_in_eval = true;
+		scm_with_guile(c_wrap_apply_tv_batch, this);
+		_in_eval = false;
+		_batch_args = NULL;
+
+#ifdef WORK_AROUND_GUILE_THREADING_BUG
+		thread_unlock();
+#endif /* WORK_AROUND_GUILE_THREADING_BUG */
+		ExecControl::check_current();
+		if (eval_error())
+			throw RuntimeException(TRACE_INFO, "%s", _error_msg.c_str());
+	}
+
+	// As in apply_tv(), do not hold long-term references to the TV's.
+	std::vector<TruthValuePtr> rtvs;
+	swap(rtvs, _batch_tvs);
+	if (rtvs.size() != arglists.size())
+		throw RuntimeException(TRACE_INFO,
+			"Batched call to %s returned %zu TruthValues for %zu "
+			"argument lists!", func.c_str(), rtvs.size(), arglists.size());
+	return rtvs;
+}
+
+void * SchemeEval::c_wrap_apply_tv_batch(void * p)
+{
+	SchemeEval *self = (SchemeEval *) p;
+	if (self->watch_control())
+		self->do_apply_tv_batch(*self->_pexpr, *self->_batch_args);
+	self->unwatch_control();
+	return self;
+}
+
+void SchemeEval::do_apply_tv_batch(const std::string& func,
+                                   const HandleSeq& arglists)
+{
+	_batch_tvs.clear();
+
+	// Transpose the argument lists into columns. Only stack variables
+	// hold SCM values here, so that the garbage collector sees them.
+	size_t nargs = arglists.size();
+	Arity arity = LIST_LINK == arglists[0]->getType() ?
+		arglists[0]->getArity() : 1;
+	SCM expr = SCM_EOL;
+	for (int k = arity-1; 0 <= k; k--)
+	{
+		SCM col = SCM_EOL;
+		for (int i = nargs-1; 0 <= i; i--)
+		{
+			const Handle& al = arglists[i];
+			const Handle& h = LIST_LINK == al->getType() ?
+				al->getOutgoingAtom(k) : al;
+			col = scm_cons(SchemeSmob::handle_to_scm(h), col);
+		}
+		expr = scm_cons(col, expr);
+	}
+
+	SCM svar = lookup_proc(func);
+	SCM rc;
+	if (scm_is_false(svar))
+	{
+		expr = scm_cons(scm_from_utf8_symbol(func.c_str()), expr);
+		rc = do_scm_eval(expr, thunk_scm_eval);
+	}
+	else
+	{
+		expr = scm_cons(svar, expr);
+		rc = do_scm_eval(expr, thunk_scm_apply);
+	}
+	if (eval_error()) return;
+
+	_batch_tvs.reserve(nargs);
+	for (; scm_is_pair(rc); rc = scm_cdr(rc))
+		_batch_tvs.emplace_back(SchemeSmob::to_tv(scm_car(rc)));
+}
+
 /* ============================================================== */
 
 // A pool of scheme evaluators, sitting hot and ready to go.
@@ -1248,13 +1551,13 @@ void * SchemeEval::c_wrap_apply_tv(void * p)
 // reason this is done with a pool, instead of simply new() and
 // delete() is because calling delete() from TLS conflicts with
 // the guile garbage collector, when the thread is destroyed. See
-// the note below.
+// the note below.  The stack does its own locking; evaluators are
+// only taken from it the first time a thread needs one for a given
+// atomspace, and so it is never on the evaluation path.
 static concurrent_stack<SchemeEval*> pool;
-static std::mutex pool_mtx;
 
 static SchemeEval* get_from_pool(void)
 {
-	std::lock_guard<std::mutex> lock(pool_mtx);
 	SchemeEval* ev = NULL;
 	if (pool.try_pop(ev)) return ev;
 	return new SchemeEval();
@@ -1262,7 +1565,6 @@ static SchemeEval* get_from_pool(void)
 
 static void return_to_pool(SchemeEval* ev)
 {
-	std::lock_guard<std::mutex> lock(pool_mtx);
 	pool.push(ev);
 }
 
@@ -9,13 +9,17 @@
 #define OPENCOG_SCHEME_EVAL_H
 #ifdef HAVE_GUILE
 
+#include <atomic>
 #include <condition_variable>
 #include <mutex>
 #include <string>
 #include <sstream>
+#include <unordered_map>
+#include <vector>
 #include <cstddef>
 #include <libguile.h>
 #include <opencog/atoms/base/Handle.h>
+#include <opencog/atomutils/ExecControl.h>
 #include <opencog/eval/GenericEval.h>
 #include <opencog/truthvalue/TruthValue.h>
 #include <opencog/util/exceptions.h>
@@ -90,9 +94,25 @@ class SchemeEval : public GenericEval
 		static void * c_wrap_eval(void *);
 		static void * c_wrap_poll(void *);
 
-		// Support for interruption from a shell.
+		// Support for interruption from a shell.  _generation changes
+		// each time _eval_thread does, so that an interrupt aimed at
+		// one evaluation cannot hit the next; both are guarded by
+		// _interrupt_mtx.
 		SCM _eval_thread;
+		std::atomic_bool _interrupted;
+		std::mutex _interrupt_mtx;
+		size_t _generation;
+		void interrupt(size_t generation);
 		static void * c_wrap_interrupt(void *);
+
+		// Applied procedures are interrupted, likewise, when the
+		// ExecControl they run under is cancelled.
+		ExecControl* _control;
+		size_t _control_irq;
+		SCM _saved_eval_thread;
+		std::atomic_bool* _saved_interrupted;
+		bool watch_control(void);
+		void unwatch_control(void);
 		
 		// Output port, for any printing done by scheme code.
 		SCM _outport;
@@ -117,9 +137,31 @@ class SchemeEval : public GenericEval
 		AtomSpace* _retas;
 		Handle do_apply(const std::string& func, const Handle& varargs);
 		SCM do_apply_scm(const std::string& func, const Handle& varargs);
+
+		// The variables that applied function names are bound to, so
+		// that apply() does not need to build and evaluate a fresh
+		// expression on each call.  Each is protected from the garbage
+		// collector for as long as it is held here, along with the
+		// module it was resolved in.
+		struct Proc
+		{
+			SCM module;
+			SCM sym;
+			SCM var;
+			bool local;
+		};
+		std::unordered_map<std::string, Proc> _procs;
+		SCM lookup_proc(const std::string& func);
+		void clear_procs(void);
 		static void * c_wrap_apply(void *);
 		static void * c_wrap_apply_tv(void *);
 
+		// Apply function to a batch of argument lists, returning TV's
+		const HandleSeq* _batch_args;
+		std::vector<TruthValuePtr> _batch_tvs;
+		void do_apply_tv_batch(const std::string& func, const HandleSeq&);
+		static void * c_wrap_apply_tv_batch(void *);
+
 		// Exception and error handling stuff
 		SCM _error_string;
 		std::string _error_msg;
@@ -146,6 +188,13 @@ class SchemeEval : public GenericEval
 		// Set per-thread global
 		static void set_scheme_as(AtomSpace*);
 
+		// Declare that all scripts have been loaded, and that all
+		// top-level defines are done. From then on, evaluators in
+		// different threads run concurrently, even on old guile
+		// versions that otherwise need all evaluation serialized.
+		static void enable_threads(void);
+		static bool threads_enabled(void);
+
 		SchemeEval(AtomSpace* = NULL);
 		~SchemeEval();
 
@@ -179,6 +228,11 @@ class SchemeEval : public GenericEval
 		Handle apply(const std::string& func, Handle varargs);
 		TruthValuePtr apply_tv(const std::string& func, Handle varargs);
 
+		// Apply expression once, to a whole batch of argument lists,
+		// returning one TV per list. See apply_tv_batch() for details.
+		std::vector<TruthValuePtr> apply_tv_batch(const std::string& func,
+		                                          const HandleSeq& arglists);
+
 		// Nested invocations
 		bool recursing(void) { return _in_eval; }
 };
@@ -277,6 +277,15 @@ void SchemeSmob::register_procs()
 	register_proc("cog-incoming-by-type",  2, 0, 0, C(ss_incoming_by_type));
 	register_proc("cog-outgoing-set",      1, 0, 0, C(ss_outgoing_set));
 	register_proc("cog-outgoing-atom",     2, 0, 0, C(ss_outgoing_atom));
+
+	// Bulk atom creation, and vector-valued queries
+	register_proc("cog-new-tree",          1, 0, 1, C(ss_new_tree));
+	register_proc("cog-new-trees",         1, 0, 1, C(ss_new_trees));
+	register_proc("cog-outgoing-vector",   1, 0, 0, C(ss_outgoing_vector));
+	register_proc("cog-incoming-vector",   1, 0, 0, C(ss_incoming_vector));
+	register_proc("cog-incoming-by-type-vector", 2, 0, 0, C(ss_incoming_by_type_vector));
+	register_proc("cog-get-atoms-vector",  1, 1, 0, C(ss_get_atoms_vector));
+
 	register_proc("cog-tv",                1, 0, 0, C(ss_tv));
 	register_proc("cog-av",                1, 0, 0, C(ss_av));
 	register_proc("cog-as",                1, 0, 0, C(ss_as));
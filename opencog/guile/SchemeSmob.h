@@ -117,6 +117,16 @@ private:
 	static SCM ss_outgoing_set(SCM);
 	static SCM ss_outgoing_atom(SCM, SCM);
 
+	// Bulk atom creation, and vector-valued queries
+	static Handle tree_to_handle(AtomSpace*, SCM);
+	static SCM handles_to_vector(const HandleSeq&);
+	static SCM ss_new_tree(SCM, SCM);
+	static SCM ss_new_trees(SCM, SCM);
+	static SCM ss_outgoing_vector(SCM);
+	static SCM ss_incoming_vector(SCM);
+	static SCM ss_incoming_by_type_vector(SCM, SCM);
+	static SCM ss_get_atoms_vector(SCM, SCM);
+
 	// Type query functions
 	static SCM ss_map_type(SCM, SCM);
 	static SCM ss_get_types(void);
@@ -0,0 +1,250 @@
+/*
+ * SchemeSmobBulk.cc
+ *
+ * Scheme small objects (SMOBS) -- bulk atom creation and queries.
+ *
+ * Loading large scheme files makes millions of calls to cog-new-node
+ * and cog-new-link, each of which crosses from guile into C++, and
+ * each of which allocates a smob for an intermediate atom that is
+ * thrown away as soon as the enclosing link is made.  The functions
+ * here take an entire s-expression tree, and build it in one call.
+ * The query functions return vectors instead of lists, so that the
+ * result is allocated once, instead of one cons cell at a time.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifdef HAVE_GUILE
+
+#include <vector>
+
+#include <cstddef>
+#include <libguile.h>
+
+#include <opencog/util/exceptions.h>
+#include <opencog/atomspace/AtomSpace.h>
+#include <opencog/atoms/base/ClassServer.h>
+#include <opencog/guile/SchemeSmob.h>
+
+using namespace opencog;
+
+/* ============================================================== */
+/**
+ * Convert an s-expression into an atom, adding it, and everything
+ * below it, to the atomspace.
+ *
+ * The s-expression has the form (TYPE ARG ...) where TYPE is the
+ * symbol (or string) name of an atom type.  For node types, the
+ * first ARG is the node name (a string, or a number for NumberNodes).
+ * For link types, each ARG is either an atom, or another s-expression
+ * of the same form.  In both cases, a truth value or attention value
+ * may appear amongst the ARGs, and is then set on the atom.
+ *
+ * Throws InvalidParamException on malformed input; the caller is
+ * expected to convert that into a scheme error.
+ */
+Handle SchemeSmob::tree_to_handle(AtomSpace* as, SCM stree)
+{
+	// Atoms may appear anywhere that a tree may.
+	Handle h(scm_to_handle(stree));
+	if (h) return as->add_atom(h);
+
+	if (not scm_is_pair(stree))
+		throw InvalidParamException(TRACE_INFO,
+			"Expecting an atom or an atom tree");
+
+	SCM stype = SCM_CAR(stree);
+	if (scm_is_true(scm_symbol_p(stype)))
+		stype = scm_symbol_to_string(stype);
+	if (scm_is_false(scm_string_p(stype)))
+		throw InvalidParamException(TRACE_INFO,
+			"Expecting the name of an atom type");
+
+	char* ctype = scm_to_utf8_string(stype);
+	Type t = classserver().getType(ctype);
+	if (NOTYPE == t)
+	{
+		std::string tname(ctype);
+		free(ctype);
+		throw InvalidParamException(TRACE_INFO,
+			"Not an atom type: %s", tname.c_str());
+	}
+	free(ctype);
+
+	SCM sargs = SCM_CDR(stree);
+	if (classserver().isNode(t))
+	{
+		SCM sname = scm_is_pair(sargs) ? SCM_CAR(sargs) : SCM_EOL;
+		if (classserver().isA(t, NUMBER_NODE) and scm_is_number(sname))
+			sname = scm_number_to_string(sname, _radix_ten);
+		if (not scm_is_string(sname))
+			throw InvalidParamException(TRACE_INFO,
+				"Expecting a name for the %s",
+				classserver().getTypeName(t).c_str());
+
+		char* cname = scm_to_utf8_string(sname);
+		std::string name(cname);
+		free(cname);
+
+		h = as->add_node(t, name);
+		sargs = SCM_CDR(sargs);
+	}
+	else
+	{
+		HandleSeq oset;
+		for (SCM sl = sargs; scm_is_pair(sl); sl = SCM_CDR(sl))
+		{
+			SCM sarg = SCM_CAR(sl);
+
+			// Truth and attention values are picked up below.
+			if (SCM_SMOB_PREDICATE(SchemeSmob::cog_misc_tag, sarg) and
+			    nullptr == scm_to_handle(sarg))
+				continue;
+			if (scm_is_null(sarg)) continue;
+
+			oset.emplace_back(tree_to_handle(as, sarg));
+		}
+		h = as->add_link(t, oset);
+	}
+
+	const TruthValue *tv = get_tv_from_list(sargs);
+	if (tv) h->setTruthValue(tv->clone());
+
+	const AttentionValue *av = get_av_from_list(sargs);
+	if (av) h->setAttentionValue(av->clone());
+
+	return h;
+}
+
+/**
+ * Create an entire tree of atoms, given as an s-expression, e.g.
+ *    (cog-new-tree '(ListLink (ConceptNode "a") (ConceptNode "b")))
+ * Only the root of the tree is returned to scheme.
+ */
+SCM SchemeSmob::ss_new_tree (SCM stree, SCM kv_pairs)
+{
+	AtomSpace* atomspace = get_as_from_list(kv_pairs);
+	if (NULL == atomspace) atomspace = ss_get_env_as("cog-new-tree");
+
+	Handle h;
+	try
+	{
+		h = tree_to_handle(atomspace, stree);
+	}
+	catch (const std::exception& ex)
+	{
+		throw_exception(ex, "cog-new-tree");
+	}
+	scm_remember_upto_here_2(stree, kv_pairs);
+	return handle_to_scm(h);
+}
+
+/**
+ * Create many trees of atoms, given as a list of s-expressions.
+ * Nothing is returned to scheme but the number of trees created, so
+ * that bulk loading does not allocate any smobs at all.
+ */
+SCM SchemeSmob::ss_new_trees (SCM strees, SCM kv_pairs)
+{
+	if (not scm_is_pair(strees) and not scm_is_null(strees))
+		scm_wrong_type_arg_msg("cog-new-trees", 1, strees,
+			"a list of atom trees");
+
+	AtomSpace* atomspace = get_as_from_list(kv_pairs);
+	if (NULL == atomspace) atomspace = ss_get_env_as("cog-new-trees");
+
+	size_t count = 0;
+	try
+	{
+		for (SCM sl = strees; scm_is_pair(sl); sl = SCM_CDR(sl))
+		{
+			tree_to_handle(atomspace, SCM_CAR(sl));
+			count++;
+		}
+	}
+	catch (const std::exception& ex)
+	{
+		throw_exception(ex, "cog-new-trees");
+	}
+	scm_remember_upto_here_2(strees, kv_pairs);
+	return scm_from_size_t(count);
+}
+
+/* ============================================================== */
+/**
+ * Convert a sequence of handles into a scheme vector.
+ */
+SCM SchemeSmob::handles_to_vector(const HandleSeq& hs)
+{
+	SCM svec = scm_c_make_vector(hs.size(), SCM_EOL);
+	for (size_t i = 0; i < hs.size(); i++)
+		SCM_SIMPLE_VECTOR_SET(svec, i, handle_to_scm(hs[i]));
+	return svec;
+}
+
+/**
+ * Return the outgoing set of an atom, as a vector.
+ */
+SCM SchemeSmob::ss_outgoing_vector (SCM satom)
+{
+	Handle h = verify_handle(satom, "cog-outgoing-vector");
+
+	if (not h->isLink()) return scm_c_make_vector(0, SCM_EOL);
+	return handles_to_vector(h->getOutgoingSet());
+}
+
+/**
+ * Return the incoming set of an atom, as a vector.
+ */
+SCM SchemeSmob::ss_incoming_vector (SCM satom)
+{
+	Handle h = verify_handle(satom, "cog-incoming-vector");
+
+	HandleSeq iset;
+	h->getIncomingSet(std::back_inserter(iset));
+	return handles_to_vector(iset);
+}
+
+/**
+ * Return the incoming set of an atom, of the given type, as a vector.
+ */
+SCM SchemeSmob::ss_incoming_by_type_vector (SCM satom, SCM stype)
+{
+	Handle h = verify_handle(satom, "cog-incoming-by-type-vector");
+	Type t = verify_atom_type(stype, "cog-incoming-by-type-vector", 2);
+
+	HandleSeq iset;
+	h->getIncomingSetByType(std::back_inserter(iset), t, false);
+	return handles_to_vector(iset);
+}
+
+/**
+ * Return all atoms of the given type, as a vector.  Unlike
+ * cog-get-atoms, this does not call back into scheme once per atom.
+ */
+SCM SchemeSmob::ss_get_atoms_vector (SCM stype, SCM ssubtypes)
+{
+	Type t = verify_atom_type(stype, "cog-get-atoms-vector");
+	bool subtypes = not SCM_UNBNDP(ssubtypes) and scm_is_true(ssubtypes);
+	AtomSpace* atomspace = ss_get_env_as("cog-get-atoms-vector");
+
+	HandleSeq hs;
+	atomspace->get_handles_by_type(hs, t, subtypes);
+	return handles_to_vector(hs);
+}
+
+#endif
+/* ===================== END OF FILE ============================ */
@@ -0,0 +1,423 @@
+/*
+ * opencog/persist/file/FastLoader.cc
+ *
+ * Load scheme files of atoms without going through guile.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+#include <opencog/util/Logger.h>
+#include <opencog/util/exceptions.h>
+
+#include <opencog/atoms/base/ClassServer.h>
+#include <opencog/truthvalue/SimpleTruthValue.h>
+
+#include "FastLoader.h"
+
+using namespace opencog;
+
+// ==========================================================
+
+FastLoader::FastLoader(AtomSpace* as, FallbackCB fallback) :
+	_as(as),
+	_fallback(fallback),
+	_fallback_count(0)
+{
+	if (nullptr == as)
+		throw InvalidParamException(TRACE_INFO,
+			"FastLoader: an AtomSpace is required");
+}
+
+// ==========================================================
+// Reading
+
+/// Skip a block comment, either #| ... |# or #! ... !#, the opening
+/// two characters of which have already been read.
+static void skip_block_comment(FILE* f, int close, size_t& line)
+{
+	int prev = 0;
+	int c;
+	while (EOF != (c = getc(f)))
+	{
+		if ('\n' == c) line++;
+		if (close == prev and '#' == c) return;
+		prev = c;
+	}
+}
+
+/// Read the text of the next top-level form into `form`, dropping
+/// comments.  `line` is advanced past every newline read, so that it
+/// is the line on which the form ended.  Returns false at end of file.
+bool FastLoader::read_form(FILE* f, std::string& form, size_t& line)
+{
+	form.clear();
+	int depth = 0;
+	bool in_string = false;
+	int c;
+
+	while (EOF != (c = getc(f)))
+	{
+		if ('\n' == c) line++;
+
+		if (in_string)
+		{
+			form.push_back(c);
+			if ('\\' == c)
+			{
+				c = getc(f);
+				if (EOF == c) break;
+				if ('\n' == c) line++;
+				form.push_back(c);
+			}
+			else if ('"' == c) in_string = false;
+			continue;
+		}
+
+		if (';' == c)
+		{
+			while (EOF != (c = getc(f)) and '\n' != c) {}
+			line++;
+			c = '\n';
+		}
+		else if ('#' == c)
+		{
+			int d = getc(f);
+			if ('|' == d or '!' == d)
+			{
+				skip_block_comment(f, d, line);
+				c = ' ';
+			}
+			else
+			{
+				form.push_back(c);
+				if (EOF == d) break;
+				if ('\n' == d) line++;
+				// Character literals, e.g. #\( must not count as parens.
+				c = d;
+				if ('\\' == d)
+				{
+					form.push_back(d);
+					c = getc(f);
+					if (EOF == c) break;
+					form.push_back(c);
+					continue;
+				}
+			}
+		}
+
+		if (isspace(c))
+		{
+			if (0 == depth and not form.empty()) return true;
+			if (not form.empty()) form.push_back(' ');
+			continue;
+		}
+
+		form.push_back(c);
+		if ('"' == c) in_string = true;
+		else if ('(' == c) depth++;
+		else if (')' == c and 0 == --depth) return true;
+	}
+
+	// Unbalanced forms at the end of the file still go to the
+	// fallback; it is up to it to report them.
+	return not form.empty();
+}
+
+/// Parse one s-expression, starting at `pos`.  Only lists, symbols
+/// and plain strings are recognised; quotes and other reader syntax
+/// make this return false.
+bool FastLoader::parse_sexpr(const std::string& text, size_t& pos,
+                             Sexpr& sx)
+{
+	while (pos < text.size() and isspace(text[pos])) pos++;
+	if (pos >= text.size()) return false;
+
+	char c = text[pos];
+	if ('(' == c)
+	{
+		sx.kind = Sexpr::LIST;
+		pos++;
+		while (true)
+		{
+			while (pos < text.size() and isspace(text[pos])) pos++;
+			if (pos >= text.size()) return false;
+			if (')' == text[pos]) { pos++; return true; }
+
+			sx.kids.emplace_back();
+			if (not parse_sexpr(text, pos, sx.kids.back())) return false;
+		}
+	}
+
+	if ('"' == c)
+	{
+		sx.kind = Sexpr::STRING;
+		pos++;
+		while (pos < text.size())
+		{
+			c = text[pos++];
+			if ('"' == c) return true;
+			if ('\\' != c) { sx.text.push_back(c); continue; }
+
+			if (pos >= text.size()) return false;
+			c = text[pos++];
+			switch (c)
+			{
+				case 'n': sx.text.push_back('\n'); break;
+				case 't': sx.text.push_back('\t'); break;
+				case '"':
+				case '\\': sx.text.push_back(c); break;
+				default: return false;
+			}
+		}
+		return false;
+	}
+
+	if (')' == c or '\'' == c or '`' == c or ',' == c or '#' == c)
+		return false;
+
+	sx.kind = Sexpr::SYMBOL;
+	while (pos < text.size())
+	{
+		c = text[pos];
+		if (isspace(c) or '(' == c or ')' == c or '"' == c) break;
+		sx.text.push_back(c);
+		pos++;
+	}
+	return true;
+}
+
+// ==========================================================
+// Recognising and building atoms
+
+bool FastLoader::is_number(const std::string& s, double& val)
+{
+	if (s.empty()) return false;
+	char* end;
+	errno = 0;
+	val = strtod(s.c_str(), &end);
+	return 0 == errno and '\0' == *end;
+}
+
+/// If `sx` is (stv MEAN CONF), set `tv` and return true.
+bool FastLoader::get_tv(const Sexpr& sx, TruthValuePtr& tv)
+{
+	if (Sexpr::LIST != sx.kind or 3 != sx.kids.size()) return false;
+	const Sexpr& head = sx.kids[0];
+	if (Sexpr::SYMBOL != head.kind) return false;
+	if (head.text != "stv" and head.text != "cog-new-stv") return false;
+
+	double mean, conf;
+	if (Sexpr::SYMBOL != sx.kids[1].kind or
+	    not is_number(sx.kids[1].text, mean)) return false;
+	if (Sexpr::SYMBOL != sx.kids[2].kind or
+	    not is_number(sx.kids[2].text, conf)) return false;
+
+	tv = SimpleTruthValue::createTV(mean, conf);
+	return true;
+}
+
+/// Return true if `sx` consists entirely of atom constructors, with
+/// names, atoms and truth values as their arguments.
+bool FastLoader::is_atom_expr(const Sexpr& sx)
+{
+	if (Sexpr::LIST != sx.kind or sx.kids.empty()) return false;
+	if (Sexpr::SYMBOL != sx.kids[0].kind) return false;
+
+	Type t = classserver().getType(sx.kids[0].text);
+	if (NOTYPE == t) return false;
+
+	TruthValuePtr tv;
+	if (classserver().isNode(t))
+	{
+		size_t nnames = 0;
+		for (size_t i = 1; i < sx.kids.size(); i++)
+		{
+			const Sexpr& arg = sx.kids[i];
+			if (get_tv(arg, tv)) continue;
+
+			double val;
+			if (Sexpr::STRING == arg.kind)
+				nnames++;
+			else if (Sexpr::SYMBOL == arg.kind and
+			         classserver().isA(t, NUMBER_NODE) and
+			         is_number(arg.text, val))
+				nnames++;
+			else
+				return false;
+		}
+		return 1 == nnames;
+	}
+
+	if (not classserver().isLink(t)) return false;
+
+	for (size_t i = 1; i < sx.kids.size(); i++)
+	{
+		const Sexpr& arg = sx.kids[i];
+		if (get_tv(arg, tv)) continue;
+		if (not is_atom_expr(arg)) return false;
+	}
+	return true;
+}
+
+/// Add the atoms of a checked expression, bottom-up.
+Handle FastLoader::build(const Sexpr& sx)
+{
+	Type t = classserver().getType(sx.kids[0].text);
+	TruthValuePtr tv;
+	Handle h;
+
+	if (classserver().isNode(t))
+	{
+		std::string name;
+		for (size_t i = 1; i < sx.kids.size(); i++)
+			if (not get_tv(sx.kids[i], tv)) name = sx.kids[i].text;
+		h = _as->add_node(t, name);
+	}
+	else
+	{
+		HandleSeq oset;
+		for (size_t i = 1; i < sx.kids.size(); i++)
+			if (not get_tv(sx.kids[i], tv))
+				oset.emplace_back(build(sx.kids[i]));
+		h = _as->add_link(t, oset);
+	}
+
+	if (tv) h->setTruthValue(tv);
+	return h;
+}
+
+Handle FastLoader::load_expr(const std::string& text)
+{
+	Sexpr sx;
+	size_t pos = 0;
+	if (not parse_sexpr(text, pos, sx)) return Handle::UNDEFINED;
+	while (pos < text.size() and isspace(text[pos])) pos++;
+	if (pos != text.size()) return Handle::UNDEFINED;
+	if (not is_atom_expr(sx)) return Handle::UNDEFINED;
+	return build(sx);
+}
+
+// ==========================================================
+// Files
+
+void FastLoader::load_form(const std::string& form,
+                           const std::string& filename, size_t line)
+{
+	_fallback_count++;
+	if (_fallback)
+	{
+		_fallback(form);
+		return;
+	}
+	logger().warn("FastLoader: %s:%zu: skipping unrecognised form: %.60s",
+	              filename.c_str(), line, form.c_str());
+}
+
+size_t FastLoader::load_file(const std::string& filename)
+{
+	FILE* f = fopen(filename.c_str(), "r");
+	if (nullptr == f)
+		throw RuntimeException(TRACE_INFO,
+			"FastLoader: cannot open %s: %s",
+			filename.c_str(), strerror(errno));
+
+	size_t loaded = 0;
+	size_t line = 1;
+	std::string form;
+	try
+	{
+		while (read_form(f, form, line))
+		{
+			Handle h;
+			try
+			{
+				h = load_expr(form);
+			}
+			catch (const std::exception& ex)
+			{
+				throw RuntimeException(TRACE_INFO,
+					"FastLoader: %s:%zu: %s",
+					filename.c_str(), line, ex.what());
+			}
+			if (h) loaded++;
+			else load_form(form, filename, line);
+		}
+	}
+	catch (...)
+	{
+		fclose(f);
+		throw;
+	}
+	fclose(f);
+
+	logger().debug("FastLoader: loaded %zu forms from %s",
+	               loaded, filename.c_str());
+	return loaded;
+}
+
+size_t FastLoader::load_files(const std::vector<std::string>& filenames,
+                              unsigned int nthreads)
+{
+	if (nthreads > filenames.size()) nthreads = filenames.size();
+	if (nthreads <= 1)
+	{
+		size_t loaded = 0;
+		for (const std::string& fn : filenames)
+			loaded += load_file(fn);
+		return loaded;
+	}
+
+	// Threads take the next file, until there are none left. The
+	// first error stops all threads from starting new files.
+	std::atomic<size_t> next(0);
+	std::atomic<size_t> loaded(0);
+	std::exception_ptr error;
+	std::mutex error_mtx;
+
+	auto worker = [&]()
+	{
+		size_t i;
+		while ((i = next++) < filenames.size())
+		{
+			try
+			{
+				loaded += load_file(filenames[i]);
+			}
+			catch (...)
+			{
+				std::lock_guard<std::mutex> lck(error_mtx);
+				if (not error) error = std::current_exception();
+				next = filenames.size();
+			}
+		}
+	};
+
+	std::vector<std::thread> pool;
+	for (unsigned int i = 0; i < nthreads; i++)
+		pool.push_back(std::thread(worker));
+	for (std::thread& t : pool) t.join();
+
+	if (error) std::rethrow_exception(error);
+	return loaded;
+}
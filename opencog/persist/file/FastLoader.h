@@ -0,0 +1,124 @@
+/*
+ * opencog/persist/file/FastLoader.h
+ *
+ * Load scheme files of atoms without going through guile.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_FAST_LOADER_H
+#define _OPENCOG_FAST_LOADER_H
+
+#include <atomic>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <opencog/atoms/base/Handle.h>
+#include <opencog/truthvalue/TruthValue.h>
+#include <opencog/atomspace/AtomSpace.h>
+
+namespace opencog
+{
+/** \addtogroup grp_persist
+ *  @{
+ */
+
+/**
+ * Streaming loader for .scm files that hold atoms, such as
+ *
+ *    (EvaluationLink (stv 0.9 0.8)
+ *       (PredicateNode "likes")
+ *       (ListLink (ConceptNode "Alice") (ConceptNode "Bob")))
+ *
+ * Each top-level form that consists only of atom constructors, string
+ * and number literals, and (stv MEAN CONF) truth values, is parsed in
+ * C++ and added directly to the AtomSpace, bottom-up, one atom at a
+ * time; no scheme objects are ever created.  This is many times faster
+ * than primitive-load.
+ *
+ * Any other top-level form -- a define, a use-modules, an atom that
+ * refers to a scheme variable, and so on -- is handed, as text, to the
+ * fallback callback, in file order.  Typically, the callback evaluates
+ * it with guile.  Without a callback, such forms are logged and
+ * skipped.
+ *
+ * The loader does not check the forms it cannot parse: one with bad
+ * syntax, or left unbalanced at the end of the file, goes to the
+ * callback like any other.  A callback that evaluates the forms must
+ * itself turn read errors and incomplete input into errors, or such
+ * forms are silently lost.  The fast-load scheme primitive throws.
+ *
+ * load_files() loads several files concurrently, one file per thread.
+ * In that case, the fallback callback is called from the worker
+ * threads, and must be thread-safe.
+ */
+class FastLoader
+{
+	public:
+		typedef std::function<void(const std::string&)> FallbackCB;
+
+	private:
+		struct Sexpr
+		{
+			enum { LIST, SYMBOL, STRING } kind;
+			std::string text;
+			std::vector<Sexpr> kids;
+		};
+
+		AtomSpace* _as;
+		FallbackCB _fallback;
+		std::atomic<size_t> _fallback_count;
+
+		// Reading
+		static bool read_form(FILE*, std::string&, size_t&);
+		static bool parse_sexpr(const std::string&, size_t&, Sexpr&);
+
+		// Recognising and building atoms
+		static bool is_number(const std::string&, double&);
+		static bool get_tv(const Sexpr&, TruthValuePtr&);
+		static bool is_atom_expr(const Sexpr&);
+		Handle build(const Sexpr&);
+
+		void load_form(const std::string&, const std::string&, size_t);
+
+	public:
+		FastLoader(AtomSpace*, FallbackCB fallback = nullptr);
+		FastLoader(const FastLoader&) = delete;
+		FastLoader& operator=(const FastLoader&) = delete;
+
+		/// Load every top-level form in the file. Returns the number
+		/// of forms that were loaded without the fallback.
+		size_t load_file(const std::string& filename);
+
+		/// Load several files, using up to `nthreads` threads.
+		size_t load_files(const std::vector<std::string>& filenames,
+		                  unsigned int nthreads = 1);
+
+		/// Parse and add a single atom expression. Returns
+		/// Handle::UNDEFINED if it is not a pure atom expression;
+		/// the fallback is not called.
+		Handle load_expr(const std::string&);
+
+		/// Number of forms handed to the fallback (or skipped).
+		size_t get_fallback_count(void) const { return _fallback_count; }
+};
+
+/** @}*/
+} //namespace opencog
+
+#endif // _OPENCOG_FAST_LOADER_H
@@ -0,0 +1,690 @@
+/*
+ * opencog/persist/file/WALBackingStore.cc
+ *
+ * Append-only, write-ahead log storage for the AtomSpace.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <algorithm>
+#include <chrono>
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include <boost/bind.hpp>
+
+#include <opencog/util/Logger.h>
+#include <opencog/util/exceptions.h>
+
+#include <opencog/atoms/base/ClassServer.h>
+#include <opencog/truthvalue/CountTruthValue.h>
+#include <opencog/truthvalue/IndefiniteTruthValue.h>
+#include <opencog/truthvalue/ProbabilisticTruthValue.h>
+#include <opencog/truthvalue/SimpleTruthValue.h>
+
+#include "WALBackingStore.h"
+
+using namespace opencog;
+
+/*
+ * The log and the snapshot share a single, line-oriented text format.
+ * The first line is a header, "S <gen>" for the snapshot and "G <gen>"
+ * for the log.  Each following line is one record:
+ *
+ *    N <id> <typename> <tv> <namelen> <name>
+ *    L <id> <typename> <tv> <arity> <id> <id> ...
+ *    X <id>
+ *    T <id> <tv>
+ *    V <id> <sti> <lti> <vlti>
+ *
+ * where <tv> is "<tvtype>" for a null truth value, else
+ * "<tvtype> <a> <b> <c>".  The node name is length-prefixed, so it may
+ * contain anything at all, including newlines.  The ID's are local to
+ * one generation of the store; a link always refers to ID's that were
+ * issued by earlier records.
+ */
+
+#define TYPENAME_SZ 128
+
+// ==========================================================
+
+WALBackingStore::WALBackingStore(const std::string& path,
+                                 unsigned int sync_ms,
+                                 size_t compact_records) :
+	_log_path(path + ".log"),
+	_snap_path(path + ".snap"),
+	_sync_ms(sync_ms),
+	_compact_records(compact_records),
+	_as(nullptr),
+	_log(nullptr),
+	_generation(0),
+	_records(0),
+	_dirty(false),
+	_next_id(1),
+	_stop(false)
+{
+}
+
+WALBackingStore::~WALBackingStore()
+{
+	if (_as) unregisterWith(_as);
+}
+
+// ==========================================================
+// Writing.
+
+void WALBackingStore::log_tv(FILE* f, const TruthValuePtr& tv)
+{
+	TruthValueType tvt = NULL_TRUTH_VALUE;
+	if (tv) tvt = tv->getType();
+
+	switch (tvt)
+	{
+		case NULL_TRUTH_VALUE:
+			fprintf(f, " %d", tvt);
+			break;
+		case SIMPLE_TRUTH_VALUE:
+		case COUNT_TRUTH_VALUE:
+		case PROBABILISTIC_TRUTH_VALUE:
+			fprintf(f, " %d %.17g %.17g %.17g", tvt, tv->getMean(),
+			        tv->getConfidence(), tv->getCount());
+			break;
+		case INDEFINITE_TRUTH_VALUE:
+		{
+			IndefiniteTruthValuePtr itv = IndefiniteTVCast(tv);
+			fprintf(f, " %d %.17g %.17g %.17g", tvt, itv->getL(),
+			        itv->getU(), itv->getConfidenceLevel());
+			break;
+		}
+		default:
+			throw RuntimeException(TRACE_INFO,
+				"WALBackingStore: Unsupported truth value type %d\n", tvt);
+	}
+}
+
+void WALBackingStore::log_av(FILE* f, UUID id, const AttentionValuePtr& av)
+{
+	fprintf(f, "V %lu %hd %hd %hd\n", id,
+	        av->getSTI(), av->getLTI(), av->getVLTI());
+	_records++;
+}
+
+/// Write the atom, and, recursively, anything in its outgoing set
+/// that has not yet been written.  Returns the log ID of the atom.
+/// Caller must hold the lock.
+UUID WALBackingStore::write_atom(FILE* f, const Handle& h)
+{
+	auto it = _ids.find(h);
+	if (_ids.end() != it) return it->second;
+
+	std::vector<UUID> oids;
+	if (h->isLink())
+		for (const Handle& ho : h->getOutgoingSet())
+			oids.emplace_back(write_atom(f, ho));
+
+	UUID id = _next_id++;
+	const std::string& tname = classserver().getTypeName(h->getType());
+	if (h->isNode())
+	{
+		const std::string& name = h->getName();
+		fprintf(f, "N %lu %s", id, tname.c_str());
+		log_tv(f, h->getTruthValue());
+		fprintf(f, " %zu ", name.size());
+		fwrite(name.data(), 1, name.size(), f);
+		fputc('\n', f);
+	}
+	else
+	{
+		fprintf(f, "L %lu %s", id, tname.c_str());
+		log_tv(f, h->getTruthValue());
+		fprintf(f, " %zu", oids.size());
+		for (UUID oid : oids)
+			fprintf(f, " %lu", oid);
+		fputc('\n', f);
+	}
+	_ids.emplace(h, id);
+	_records++;
+
+	AttentionValuePtr av(h->getAttentionValue());
+	if (*av != *AttentionValue::DEFAULT_AV())
+		log_av(f, id, av);
+
+	return id;
+}
+
+// ==========================================================
+// Signal handlers. These run in whatever thread changed the atomspace.
+
+void WALBackingStore::atom_added(const Handle& h)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	if (nullptr == _log) return;
+	write_atom(_log, h);
+	_dirty = true;
+}
+
+void WALBackingStore::atom_removed(const AtomPtr& atom)
+{
+	Handle h(atom->getHandle());
+	std::lock_guard<std::mutex> lck(_mtx);
+	if (nullptr == _log) return;
+
+	auto it = _ids.find(h);
+	if (_ids.end() == it) return;
+
+	fprintf(_log, "X %lu\n", it->second);
+	_ids.erase(it);
+	_records++;
+	_dirty = true;
+}
+
+void WALBackingStore::tv_changed(const Handle& h,
+                                 const TruthValuePtr& old_tv,
+                                 const TruthValuePtr& new_tv)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	if (nullptr == _log) return;
+
+	// If the atom has not been written yet, then writing it will
+	// record the new TV as well.
+	auto it = _ids.find(h);
+	if (_ids.end() == it)
+	{
+		write_atom(_log, h);
+	}
+	else
+	{
+		fprintf(_log, "T %lu", it->second);
+		log_tv(_log, new_tv);
+		fputc('\n', _log);
+		_records++;
+	}
+	_dirty = true;
+}
+
+void WALBackingStore::av_changed(const Handle& h,
+                                 const AttentionValuePtr& old_av,
+                                 const AttentionValuePtr& new_av)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	if (nullptr == _log) return;
+
+	auto it = _ids.find(h);
+	if (_ids.end() == it)
+		write_atom(_log, h);
+	else
+		log_av(_log, it->second, new_av);
+	_dirty = true;
+}
+
+// ==========================================================
+// Replay.
+
+TruthValuePtr WALBackingStore::read_tv(FILE* f)
+{
+	int tvt;
+	if (1 != fscanf(f, " %d", &tvt)) return nullptr;
+	if (NULL_TRUTH_VALUE == tvt) return TruthValue::NULL_TV();
+
+	double a, b, c;
+	if (3 != fscanf(f, " %lg %lg %lg", &a, &b, &c)) return nullptr;
+
+	switch (tvt)
+	{
+		case SIMPLE_TRUTH_VALUE:
+			return SimpleTruthValue::createTV(a, b);
+		case COUNT_TRUTH_VALUE:
+			return CountTruthValue::createTV(a, b, c);
+		case PROBABILISTIC_TRUTH_VALUE:
+			return ProbabilisticTruthValue::createTV(a, b, c);
+		case INDEFINITE_TRUTH_VALUE:
+			return IndefiniteTruthValue::createTV(a, b, c);
+		default:
+			throw RuntimeException(TRACE_INFO,
+				"WALBackingStore: Unknown truth value type %d\n", tvt);
+	}
+}
+
+static Type read_type(FILE* f)
+{
+	char tname[TYPENAME_SZ];
+	if (1 != fscanf(f, " %127s", tname)) return NOTYPE;
+
+	Type t = classserver().getType(tname);
+	if (NOTYPE == t)
+		throw RuntimeException(TRACE_INFO,
+			"WALBackingStore: OpenCog does not have a type called %s\n",
+			tname);
+	return t;
+}
+
+static Handle lookup(std::unordered_map<UUID, Handle>& by_id, UUID id)
+{
+	auto it = by_id.find(id);
+	if (by_id.end() == it)
+		throw RuntimeException(TRACE_INFO,
+			"WALBackingStore: Record refers to unknown atom id %lu\n", id);
+	return it->second;
+}
+
+/// Read and apply one record.  Returns false at end-of-file, or if
+/// the record is incomplete, which is what a crash in the middle of
+/// a write leaves behind.
+bool WALBackingStore::replay_record(FILE* f, IdMap& by_id)
+{
+	int kind = fgetc(f);
+	if (EOF == kind) return false;
+
+	UUID id;
+	if (1 != fscanf(f, " %lu", &id)) return false;
+
+	switch (kind)
+	{
+		case 'N':
+		{
+			Type t = read_type(f);
+			TruthValuePtr tv(read_tv(f));
+			size_t len;
+			if (NOTYPE == t or nullptr == tv or
+			    1 != fscanf(f, " %zu", &len) or ' ' != fgetc(f))
+				return false;
+
+			std::string name(len, '\0');
+			if (len != fread(&name[0], 1, len, f)) return false;
+			if ('\n' != fgetc(f)) return false;
+
+			Handle h(_as->add_node(t, name));
+			if (not tv->isNullTv()) h->setTruthValue(tv);
+			by_id[id] = h;
+			_ids[h] = id;
+			break;
+		}
+		case 'L':
+		{
+			Type t = read_type(f);
+			TruthValuePtr tv(read_tv(f));
+			size_t arity;
+			if (NOTYPE == t or nullptr == tv or
+			    1 != fscanf(f, " %zu", &arity))
+				return false;
+
+			HandleSeq oset;
+			for (size_t i = 0; i < arity; i++)
+			{
+				UUID oid;
+				if (1 != fscanf(f, " %lu", &oid)) return false;
+				oset.emplace_back(lookup(by_id, oid));
+			}
+			if ('\n' != fgetc(f)) return false;
+
+			Handle h(_as->add_link(t, oset));
+			if (not tv->isNullTv()) h->setTruthValue(tv);
+			by_id[id] = h;
+			_ids[h] = id;
+			break;
+		}
+		case 'X':
+		{
+			if ('\n' != fgetc(f)) return false;
+			Handle h(lookup(by_id, id));
+			_as->extract_atom(h, true);
+			by_id.erase(id);
+			_ids.erase(h);
+			break;
+		}
+		case 'T':
+		{
+			TruthValuePtr tv(read_tv(f));
+			if (nullptr == tv or '\n' != fgetc(f)) return false;
+			lookup(by_id, id)->setTruthValue(tv);
+			break;
+		}
+		case 'V':
+		{
+			AttentionValue::sti_t sti;
+			AttentionValue::lti_t lti;
+			AttentionValue::vlti_t vlti;
+			if (3 != fscanf(f, " %hd %hd %hd", &sti, &lti, &vlti) or
+			    '\n' != fgetc(f))
+				return false;
+			lookup(by_id, id)->setAttentionValue(
+				createAV(sti, lti, vlti));
+			break;
+		}
+		default:
+			return false;
+	}
+
+	if (_next_id <= id) _next_id = id + 1;
+	return true;
+}
+
+/// Replay the snapshot or the log into the atomspace.  Returns false
+/// if the file does not exist, or (for the log) if it belongs to an
+/// older generation than the snapshot, in which case its contents
+/// are already in the snapshot.
+bool WALBackingStore::replay_file(const std::string& path,
+                                  bool is_snapshot, IdMap& by_id)
+{
+	FILE* f = fopen(path.c_str(), "r");
+	if (nullptr == f) return false;
+
+	unsigned long gen;
+	char tag = is_snapshot ? 'S' : 'G';
+	if (tag != fgetc(f) or 1 != fscanf(f, " %lu", &gen) or
+	    '\n' != fgetc(f))
+	{
+		fclose(f);
+		return false;
+	}
+
+	if (is_snapshot)
+		_generation = gen;
+	else if (gen != _generation)
+	{
+		logger().info("WALBackingStore: discarding stale log %s",
+		              path.c_str());
+		fclose(f);
+		return false;
+	}
+
+	size_t nrec = 0;
+	long good = ftell(f);
+	while (replay_record(f, by_id))
+	{
+		good = ftell(f);
+		nrec++;
+	}
+
+	// Anything after the last complete record is the remains of a
+	// write that was interrupted by a crash. Chop it off, so that
+	// new records are appended to a clean log.
+	bool torn = (ftell(f) != good);
+	fclose(f);
+	if (torn)
+	{
+		logger().warn("WALBackingStore: truncating torn record in %s",
+		              path.c_str());
+		if (truncate(path.c_str(), good))
+			throw RuntimeException(TRACE_INFO,
+				"WALBackingStore: Unable to truncate %s\n", path.c_str());
+	}
+
+	if (not is_snapshot) _records = nrec;
+	logger().info("WALBackingStore: replayed %zu records from %s",
+	              nrec, path.c_str());
+	return true;
+}
+
+// ==========================================================
+// Syncing and compaction.
+
+static void sync_dir(const std::string& path)
+{
+	size_t slash = path.rfind('/');
+	std::string dir = (std::string::npos == slash) ?
+		"." : path.substr(0, slash + 1);
+	int dfd = open(dir.c_str(), O_RDONLY);
+	if (dfd < 0) return;
+	fsync(dfd);
+	close(dfd);
+}
+
+/// Start a fresh log for the current generation.
+/// Caller must hold the lock.
+void WALBackingStore::open_log(void)
+{
+	if (_log) fclose(_log);
+	_log = fopen(_log_path.c_str(), "w");
+	if (nullptr == _log)
+		throw RuntimeException(TRACE_INFO,
+			"WALBackingStore: Unable to open %s\n", _log_path.c_str());
+
+	fprintf(_log, "G %lu\n", _generation);
+	fflush(_log);
+	fsync(fileno(_log));
+	sync_dir(_log_path);
+	_records = 0;
+	_dirty = false;
+}
+
+/// Caller must hold the lock.
+void WALBackingStore::do_sync(void)
+{
+	if (nullptr == _log) return;
+	fflush(_log);
+	fsync(fileno(_log));
+	_dirty = false;
+}
+
+/// Compact the atoms logged so far, which, once registered, are
+/// exactly those in the atomspace.  They are not fetched from the
+/// atomspace: that takes the AtomTable lock, and the remove signal,
+/// fired under that lock, waits on ours; holding ours while taking
+/// it would deadlock.
+/// Caller must hold the lock.
+void WALBackingStore::do_compact(void)
+{
+	std::vector<std::pair<UUID, Handle>> logged(_ids.begin(), _ids.end());
+	std::sort(logged.begin(), logged.end(),
+		[](const std::pair<UUID, Handle>& a, const std::pair<UUID, Handle>& b)
+		{ return a.first < b.first; });
+
+	HandleSeq all;
+	all.reserve(logged.size());
+	for (const auto& idh : logged)
+		all.push_back(idh.second);
+	do_compact(all);
+}
+
+/// Write the atoms to a new snapshot, and then start a new, empty log.
+/// If we crash after the snapshot is renamed into place, but before
+/// the new log is written, the old log will be discarded on replay,
+/// because of its older generation number.
+/// Caller must hold the lock.
+void WALBackingStore::do_compact(const HandleSeq& all)
+{
+	std::string tmp_path = _snap_path + ".tmp";
+	FILE* snap = fopen(tmp_path.c_str(), "w");
+	if (nullptr == snap)
+		throw RuntimeException(TRACE_INFO,
+			"WALBackingStore: Unable to open %s\n", tmp_path.c_str());
+
+	unsigned long gen = _generation + 1;
+	fprintf(snap, "S %lu\n", gen);
+
+	_ids.clear();
+	_next_id = 1;
+
+	for (const Handle& h : all)
+		write_atom(snap, h);
+
+	fflush(snap);
+	fsync(fileno(snap));
+	fclose(snap);
+
+	if (rename(tmp_path.c_str(), _snap_path.c_str()))
+		throw RuntimeException(TRACE_INFO,
+			"WALBackingStore: Unable to rename %s\n", tmp_path.c_str());
+	sync_dir(_snap_path);
+
+	_generation = gen;
+	open_log();
+
+	logger().info("WALBackingStore: compacted %zu atoms into %s",
+	              _ids.size(), _snap_path.c_str());
+}
+
+void WALBackingStore::sync_loop(void)
+{
+	std::unique_lock<std::mutex> lck(_mtx);
+	while (not _stop)
+	{
+		_sync_cv.wait_for(lck, std::chrono::milliseconds(_sync_ms));
+		if (_stop) break;
+
+		if (0 < _compact_records and _compact_records <= _records)
+			do_compact();
+		else if (_dirty)
+			do_sync();
+	}
+}
+
+// ==========================================================
+// The BackingStore API.
+
+/// After registration, every atom in storage is also in the
+/// atomspace; if the atomspace doesn't have it, neither do we.
+Handle WALBackingStore::getNode(Type t, const char * name) const
+{
+	return Handle::UNDEFINED;
+}
+
+Handle WALBackingStore::getLink(Handle& h) const
+{
+	return Handle::UNDEFINED;
+}
+
+HandleSeq WALBackingStore::getIncomingSet(const Handle& h) const
+{
+	return HandleSeq();
+}
+
+void WALBackingStore::loadType(AtomTable& table, Type t)
+{
+	// Everything was loaded when the store was registered.
+}
+
+/// Explicitly store the atom, including its current truth value.
+void WALBackingStore::storeAtom(const Handle& h)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	if (nullptr == _log)
+		throw RuntimeException(TRACE_INFO,
+			"WALBackingStore: Not registered with an atomspace\n");
+
+	auto it = _ids.find(h);
+	if (_ids.end() == it)
+	{
+		write_atom(_log, h);
+	}
+	else
+	{
+		fprintf(_log, "T %lu", it->second);
+		log_tv(_log, h->getTruthValue());
+		fputc('\n', _log);
+		_records++;
+	}
+	_dirty = true;
+}
+
+void WALBackingStore::barrier()
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	do_sync();
+}
+
+void WALBackingStore::compact(void)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	if (nullptr == _as)
+		throw RuntimeException(TRACE_INFO,
+			"WALBackingStore: Not registered with an atomspace\n");
+	do_compact();
+}
+
+size_t WALBackingStore::get_record_count(void)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	return _records;
+}
+
+void WALBackingStore::registerWith(AtomSpace* as)
+{
+	if (_as)
+		throw RuntimeException(TRACE_INFO,
+			"WALBackingStore: Already registered with an atomspace\n");
+
+	std::unique_lock<std::mutex> lck(_mtx);
+	_as = as;
+	_ids.clear();
+	_next_id = 1;
+	_generation = 0;
+
+	// Replay, then continue appending to the log, if it is current.
+	IdMap by_id;
+	replay_file(_snap_path, true, by_id);
+	if (replay_file(_log_path, false, by_id))
+	{
+		_log = fopen(_log_path.c_str(), "a");
+		if (nullptr == _log)
+			throw RuntimeException(TRACE_INFO,
+				"WALBackingStore: Unable to open %s\n", _log_path.c_str());
+	}
+	else
+		open_log();
+
+	// If the atomspace already held atoms that were never stored,
+	// snapshot them now, so that they become durable too.  No signal
+	// handler is connected yet, so the AtomTable lock can be taken.
+	if (_ids.size() < (size_t) _as->get_size())
+	{
+		HandleSeq all;
+		_as->get_all_atoms(all);
+		do_compact(all);
+	}
+	lck.unlock();
+
+	_add_conn = as->addAtomSignal(
+		boost::bind(&WALBackingStore::atom_added, this, _1));
+	_remove_conn = as->removeAtomSignal(
+		boost::bind(&WALBackingStore::atom_removed, this, _1));
+	_tv_conn = as->TVChangedSignal(
+		boost::bind(&WALBackingStore::tv_changed, this, _1, _2, _3));
+	_av_conn = as->AVChangedSignal(
+		boost::bind(&WALBackingStore::av_changed, this, _1, _2, _3));
+
+	BackingStore::registerWith(as);
+
+	_stop = false;
+	_syncer = std::thread(&WALBackingStore::sync_loop, this);
+}
+
+void WALBackingStore::unregisterWith(AtomSpace* as)
+{
+	if (as != _as) return;
+
+	BackingStore::unregisterWith(as);
+	_add_conn.disconnect();
+	_remove_conn.disconnect();
+	_tv_conn.disconnect();
+	_av_conn.disconnect();
+
+	std::unique_lock<std::mutex> lck(_mtx);
+	_stop = true;
+	_sync_cv.notify_all();
+	lck.unlock();
+	if (_syncer.joinable()) _syncer.join();
+
+	lck.lock();
+	do_sync();
+	fclose(_log);
+	_log = nullptr;
+	_as = nullptr;
+	_ids.clear();
+}
@@ -0,0 +1,161 @@
+/*
+ * opencog/persist/file/WALBackingStore.h
+ *
+ * Append-only, write-ahead log storage for the AtomSpace.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_WAL_BACKING_STORE_H
+#define _OPENCOG_WAL_BACKING_STORE_H
+
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include <boost/signals2.hpp>
+
+#include <opencog/atoms/base/Handle.h>
+#include <opencog/truthvalue/AttentionValue.h>
+#include <opencog/truthvalue/TruthValue.h>
+#include <opencog/atomspace/AtomSpace.h>
+#include <opencog/atomspace/BackingStore.h>
+
+namespace opencog
+{
+/** \addtogroup grp_persist
+ *  @{
+ */
+
+/**
+ * Crash-safe local-disk storage for a single AtomSpace.
+ *
+ * Every change made to the AtomSpace is appended, as a small text
+ * record, to a log file: atom additions, extractions, and changes of
+ * truth and attention values.  The records are fed from the AtomTable
+ * add, remove and TV-changed signals, and the AttentionBank AV-changed
+ * signal, so that no other code needs to know that the store exists.
+ *
+ * Writes are buffered; a background thread flushes and fsync's the
+ * log every `sync_ms` milliseconds ("group commit"), so that a crash
+ * loses at most that much work.  Use barrier() to force a sync point.
+ *
+ * After `compact_records` records have been appended, the log is
+ * compacted: the current contents of the AtomSpace are written to a
+ * snapshot file, and the log is restarted empty.  Both files carry a
+ * generation number, so that a crash part-way through compaction
+ * never replays a stale log on top of a newer snapshot.
+ *
+ * Given a path prefix of "foo", the files "foo.snap" and "foo.log"
+ * are used.  When the store is registered with an AtomSpace, the
+ * snapshot and then the log are replayed into it; from then on, the
+ * AtomSpace holds everything that the store holds.  Thus, getNode(),
+ * getLink() and getIncomingSet() never have anything more to offer,
+ * and exist only to satisfy the BackingStore interface.
+ */
+class WALBackingStore : public BackingStore
+{
+	private:
+		std::string _log_path;
+		std::string _snap_path;
+
+		// Group-commit interval, and number of records that will
+		// trigger a compaction. A compact_records of zero disables
+		// automatic compaction.
+		unsigned int _sync_ms;
+		size_t _compact_records;
+
+		AtomSpace* _as;
+		FILE* _log;
+		unsigned long _generation;
+		size_t _records;
+		bool _dirty;
+
+		// Log-local ID's for every atom that has been written to the
+		// current generation of the log. Content-compared handles.
+		std::unordered_map<Handle, UUID> _ids;
+		UUID _next_id;
+
+		// Guards everything above.
+		std::mutex _mtx;
+
+		boost::signals2::connection _add_conn;
+		boost::signals2::connection _remove_conn;
+		boost::signals2::connection _tv_conn;
+		boost::signals2::connection _av_conn;
+
+		// The group-commit thread.
+		std::thread _syncer;
+		std::condition_variable _sync_cv;
+		bool _stop;
+		void sync_loop(void);
+		void do_sync(void);
+
+		// Record writers. Caller must hold the lock.
+		void log_tv(FILE*, const TruthValuePtr&);
+		void log_av(FILE*, UUID, const AttentionValuePtr&);
+		UUID write_atom(FILE*, const Handle&);
+
+		// Signal handlers
+		void atom_added(const Handle&);
+		void atom_removed(const AtomPtr&);
+		void tv_changed(const Handle&, const TruthValuePtr&,
+		                const TruthValuePtr&);
+		void av_changed(const Handle&, const AttentionValuePtr&,
+		                const AttentionValuePtr&);
+
+		// Replay
+		typedef std::unordered_map<UUID, Handle> IdMap;
+		bool replay_file(const std::string&, bool, IdMap&);
+		bool replay_record(FILE*, IdMap&);
+		TruthValuePtr read_tv(FILE*);
+		void open_log(void);
+		void do_compact(void);
+		void do_compact(const HandleSeq&);
+
+	public:
+		WALBackingStore(const std::string& path,
+		                unsigned int sync_ms = 100,
+		                size_t compact_records = 1000000);
+		WALBackingStore(const WALBackingStore&) = delete;
+		WALBackingStore& operator=(const WALBackingStore&) = delete;
+		virtual ~WALBackingStore();
+
+		virtual Handle getNode(Type, const char *) const;
+		virtual Handle getLink(Handle&) const;
+		virtual HandleSeq getIncomingSet(const Handle&) const;
+		virtual void storeAtom(const Handle&);
+		virtual void loadType(AtomTable&, Type);
+		virtual void barrier();
+		virtual bool handlesRemoval() const { return true; }
+
+		/// Write a snapshot of the AtomSpace and restart the log.
+		void compact(void);
+
+		/// Number of records appended since the last compaction.
+		size_t get_record_count(void);
+
+		void registerWith(AtomSpace*);
+		void unregisterWith(AtomSpace*);
+};
+
+/** @}*/
+} //namespace opencog
+
+#endif // _OPENCOG_WAL_BACKING_STORE_H
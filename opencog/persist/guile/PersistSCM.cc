@@ -21,8 +21,12 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <stdlib.h>
+
 #include <opencog/atomspace/AtomSpace.h>
 #include <opencog/guile/SchemePrimitive.h>
+#include <opencog/persist/file/FastLoader.h>
+#include <opencog/util/exceptions.h>
 
 #include "PersistSCM.h"
 
@@ -61,6 +65,8 @@ void PersistSCM::init(void)
 	             &PersistSCM::load_type, this, "persist");
 	define_scheme_primitive("barrier",
 	             &PersistSCM::barrier, this, "persist");
+	define_scheme_primitive("fast-load",
+	             &PersistSCM::fast_load, this, "persist");
 }
 
 // =====================================================================
@@ -103,6 +109,49 @@ void PersistSCM::barrier(void)
 	as->barrier();
 }
 
+static SCM eval_form_body(void* form)
+{
+	return scm_c_eval_string(((const std::string*) form)->c_str());
+}
+
+static SCM eval_form_handler(void* msg, SCM key, SCM args)
+{
+	SCM port = scm_open_output_string();
+	scm_print_exception(port, SCM_BOOL_F, key, args);
+	char* str = scm_to_utf8_string(scm_get_output_string(port));
+	*((std::string*) msg) = str;
+	free(str);
+	scm_close_port(port);
+	return SCM_BOOL_F;
+}
+
+/**
+ * Load a file of atoms with the C++ loader. Forms that it does not
+ * recognise are evaluated with guile, in file order.  They are
+ * evaluated right here, rather than with an evaluator: this runs in
+ * guile mode already, perhaps inside of this thread's evaluator,
+ * which must not be re-entered.  A form that fails to read -- it has
+ * bad syntax, or is left unbalanced at the end of the file -- or to
+ * evaluate, stops the load with an error.
+ */
+int PersistSCM::fast_load(const std::string& filename)
+{
+	AtomSpace *as = SchemeSmob::ss_get_env_as("fast-load");
+
+	FastLoader loader(as, [&](const std::string& form)
+	{
+		std::string msg;
+		scm_c_catch(SCM_BOOL_T,
+		            eval_form_body, (void*) &form,
+		            eval_form_handler, &msg, NULL, NULL);
+		if (not msg.empty())
+			throw RuntimeException(TRACE_INFO,
+				"fast-load: %s: %.60s: %s",
+				filename.c_str(), form.c_str(), msg.c_str());
+	});
+	return loader.load_file(filename);
+}
+
 void opencog_persist_init(void)
 {
    static PersistSCM patty;
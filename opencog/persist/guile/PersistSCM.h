@@ -45,6 +45,7 @@ private:
 	Handle store_atom(Handle);
 	void load_type(Type);
 	void barrier(void);
+	int fast_load(const std::string&);
 
 public:
 	PersistSCM(void);
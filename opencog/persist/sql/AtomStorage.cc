@@ -21,6 +21,10 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <algorithm>
+#include <iterator>
+
+#include <opencog/atoms/base/ClassServer.h>
 #include <opencog/atomspace/AtomSpace.h>
 #include <opencog/persist/sql/AtomStorage.h>
 
@@ -37,6 +41,67 @@ AtomStorage::~AtomStorage()
     // Nothing to do in the base class.
 }
 
+HandleSeq AtomStorage::getNodes(const HandleSeq& hs)
+{
+    HandleSeq found;
+    found.reserve(hs.size());
+    for (const Handle& h : hs)
+        found.emplace_back(getNode(h->getType(), h->getName().c_str()));
+    return found;
+}
+
+HandleSeq AtomStorage::getLinks(HandleSeq& hs)
+{
+    HandleSeq found;
+    found.reserve(hs.size());
+    for (Handle& h : hs)
+        found.emplace_back(getLink(h));
+    return found;
+}
+
+HandleSeq AtomStorage::getIncomingSets(const HandleSeq& hs)
+{
+    HandleSeq iset;
+    UnorderedHandleSet seen;
+    for (const Handle& h : hs)
+        for (const Handle& hi : getIncomingSet(h))
+            if (seen.insert(hi).second)
+                iset.emplace_back(hi);
+    return iset;
+}
+
+bool AtomStorage::foreachIncoming(const Handle& h, Type t, bool subclass,
+                         const std::function<bool(const Handle&)>& cb)
+{
+    for (const Handle& hi : getIncomingSet(h))
+    {
+        Type it = hi->getType();
+        if (it != t and not (subclass and classserver().isA(it, t)))
+            continue;
+        if (cb(hi)) return true;
+    }
+    return false;
+}
+
+std::string AtomStorage::typeFilter(Type t, bool subclass,
+                                    const int* typemap)
+{
+    if (subclass and ATOM == t) return "";
+
+    std::vector<Type> types({t});
+    if (subclass)
+        classserver().getChildrenRecursive(t, std::back_inserter(types));
+
+    std::string filter = " AND type IN (";
+    for (size_t i = 0; i < types.size(); i++)
+    {
+        if (0 < i) filter += ", ";
+        filter += std::to_string(typemap[types[i]]);
+    }
+    filter += ")";
+    return filter;
+}
+
 void AtomStorage::storeAtomSpace(AtomSpace* atomspace)
 { 
     store(atomspace->get_atomtable());
@@ -53,5 +118,56 @@ void AtomStorage::clearAndLoadAtomSpace(AtomSpace* atomspace)
     load(atomspace->get_atomtable());
 }
 
+size_t AtomStorage::evictColdAtoms(AtomSpace* atomspace, size_t max_atoms)
+{
+    HandleSeq atoms;
+    atomspace->get_all_atoms(atoms);
+    if (atoms.size() <= max_atoms) return 0;
+    size_t excess = atoms.size() - max_atoms;
+
+    // Atoms with VLTI set are wanted in RAM by someone; leave them be.
+    atoms.erase(std::remove_if(atoms.begin(), atoms.end(),
+        [](const Handle& h) {
+            return h->getAttentionValue()->getVLTI() != 0; }),
+        atoms.end());
+
+    // Coldest first.
+    std::sort(atoms.begin(), atoms.end(),
+        [](const Handle& a, const Handle& b) {
+            AttentionValuePtr ava(a->getAttentionValue());
+            AttentionValuePtr avb(b->getAttentionValue());
+            if (ava->getLTI() != avb->getLTI())
+                return ava->getLTI() < avb->getLTI();
+            return ava->getSTI() < avb->getSTI();
+        });
+
+    // Only atoms with an empty incoming set can be extracted. Removing
+    // a link may free up its outgoing set, so keep making passes over
+    // the candidates until enough are gone, or no progress is made.
+    size_t evicted = 0;
+    bool progress = true;
+    while (evicted < excess and progress)
+    {
+        progress = false;
+        HandleSeq pinned;
+        for (const Handle& h : atoms)
+        {
+            if (evicted >= excess or 0 < h->getIncomingSetSize())
+            {
+                pinned.emplace_back(h);
+                continue;
+            }
+            storeAtom(h, true);
+            if (atomspace->extract_atom(h))
+            {
+                forgetAtom(h);
+                evicted++;
+                progress = true;
+            }
+        }
+        atoms.swap(pinned);
+    }
+    return evicted;
+}
 
 /* ============================= END OF FILE ================= */
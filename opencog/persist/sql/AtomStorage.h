@@ -25,6 +25,9 @@
 #ifndef _OPENCOG_ATOM_STORAGE_H
 #define _OPENCOG_ATOM_STORAGE_H
 
+#include <functional>
+#include <string>
+
 #include <opencog/atoms/base/Atom.h>
 #include <opencog/atoms/base/Link.h>
 #include <opencog/atoms/base/Node.h>
@@ -48,6 +51,22 @@ class AtomStorage
         virtual Handle getNode(Type, const char *) = 0;
         virtual Handle getLink(Handle&) = 0;
         virtual HandleSeq getIncomingSet(const Handle&) = 0;
+
+        // Batched fetches; see BackingStore for the semantics. The
+        // defaults loop over the single-atom versions.
+        virtual HandleSeq getNodes(const HandleSeq&);
+        virtual HandleSeq getLinks(HandleSeq&);
+        virtual HandleSeq getIncomingSets(const HandleSeq&);
+
+        // Call the callback on each link in the incoming set of the
+        // atom that is of the given type (or a subtype, if subclass is
+        // set), as it is read from the database, rather than after the
+        // whole set has been collected.  Stops early, and returns true,
+        // if the callback returns true.  The default implementation
+        // filters the result of getIncomingSet().
+        virtual bool foreachIncoming(const Handle&, Type, bool subclass,
+                         const std::function<bool(const Handle&)>&);
+
         virtual void storeAtom(const AtomPtr&, bool synchronous = false) = 0;
         virtual void loadType(AtomTable&, Type) = 0;
         virtual void flushStoreQueue() = 0;
@@ -65,10 +84,30 @@ class AtomStorage
         void loadAtomSpace(AtomSpace*);
         void clearAndLoadAtomSpace(AtomSpace*);
 
+        // Store, and then extract from the AtomSpace, the coldest atoms
+        // (lowest LTI, then lowest STI), until no more than max_atoms
+        // remain. Atoms with a non-zero VLTI, and atoms that are still
+        // pointed at by other atoms, are never evicted. Evicted atoms
+        // are transparently re-fetched when next added or asked for.
+        // Note that attention values are not persisted. Returns the
+        // number of atoms evicted.
+        size_t evictColdAtoms(AtomSpace*, size_t max_atoms);
+
         virtual void registerWith(AtomSpace*) = 0;
         virtual void unregisterWith(AtomSpace*) = 0;
 
     protected:
+        // Called for each atom evicted from the AtomSpace, after it has
+        // been stored. Subclasses should drop any references they hold
+        // to it (caches, TLB entries), so that its RAM can be freed.
+        virtual void forgetAtom(const Handle&) {}
+
+        // SQL fragment, of the form " AND type IN (...)", restricting
+        // the type column to the given type, and its subtypes if
+        // subclass is set. Empty if all types are wanted. The typemap
+        // converts opencog types to database type codes.
+        static std::string typeFilter(Type, bool subclass, const int* typemap);
+
         // For accessing Atom through friend relationship in subclasses.
         static AtomTable* getAtomTable(AtomPtr atom)
             { return atom->getAtomTable(); }
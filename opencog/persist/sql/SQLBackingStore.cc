@@ -54,6 +54,27 @@ HandleSeq SQLBackingStore::getIncomingSet(const Handle& h) const
 	return _store->getIncomingSet(h);
 }
 
+HandleSeq SQLBackingStore::getNodes(const HandleSeq& hs) const
+{
+	return _store->getNodes(hs);
+}
+
+HandleSeq SQLBackingStore::getLinks(HandleSeq& hs) const
+{
+	return _store->getLinks(hs);
+}
+
+HandleSeq SQLBackingStore::getIncomingSets(const HandleSeq& hs) const
+{
+	return _store->getIncomingSets(hs);
+}
+
+bool SQLBackingStore::foreachIncoming(const Handle& h, Type t, bool subclass,
+                 const std::function<bool(const Handle&)>& cb) const
+{
+	return _store->foreachIncoming(h, t, subclass, cb);
+}
+
 void SQLBackingStore::storeAtom(const Handle& h)
 {
 	_store->storeAtom(h);
@@ -56,6 +56,11 @@ class SQLBackingStore : public BackingStore
         virtual Handle getNode(Type, const char *) const;
         virtual Handle getLink(Handle&) const;
         virtual HandleSeq getIncomingSet(const Handle&) const;
+        virtual HandleSeq getNodes(const HandleSeq&) const;
+        virtual HandleSeq getLinks(HandleSeq&) const;
+        virtual HandleSeq getIncomingSets(const HandleSeq&) const;
+        virtual bool foreachIncoming(const Handle&, Type, bool,
+                     const std::function<bool(const Handle&)>&) const;
         virtual void storeAtom(const Handle&);
         virtual void loadType(AtomTable&, Type);
         virtual void barrier();
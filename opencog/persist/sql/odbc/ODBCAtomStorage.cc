@@ -31,9 +31,11 @@
 #include <stdlib.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <chrono>
 #include <memory>
 #include <thread>
+#include <unordered_map>
 
 #include <opencog/util/oc_assert.h>
 #include <opencog/atoms/base/Atom.h>
@@ -507,6 +509,15 @@ void ODBCAtomStorage::unregisterWith(AtomSpace* as)
 	_tlbuf.clear_resolver(&as->get_atomtable());
 }
 
+/// The atom was evicted from the AtomSpace, after being stored. Drop
+/// its TLB entry, so that the TLB does not pin it in RAM. Since the
+/// AtomSpace always consults storage before creating an atom, it will
+/// be re-fetched, and its UUID restored, if it is ever needed again.
+void ODBCAtomStorage::forgetAtom(const Handle& h)
+{
+	_tlbuf.removeAtom(h);
+}
+
 /* ================================================================== */
 /* AtomTable UUID stuff */
 
@@ -711,14 +722,13 @@ int ODBCAtomStorage::get_height(AtomPtr atom)
 std::string ODBCAtomStorage::oset_to_string(const HandleSeq& out,
                                         int arity)
 {
+    std::vector<UUID> uuids = _tlbuf.addAtoms(out);
     std::string str;
     str += "\'{";
     for (int i=0; i<arity; i++)
     {
-        const Handle& h = out[i];
-        UUID uuid = _tlbuf.addAtom(h, TLB::INVALID_UUID);
         if (i != 0) str += ", ";
-        str += std::to_string(uuid);
+        str += std::to_string(uuids[i]);
     }
     str += "}\'";
     return str;
@@ -1311,6 +1321,80 @@ HandleSeq ODBCAtomStorage::getIncomingSet(const Handle& h)
     return iset;
 }
 
+// Number of rows pulled from a cursor in one round trip.
+#define FETCHSZ 500
+
+/**
+ * Stream the incoming set of the indicated atom to the callback.
+ * Hub atoms can have millions of links in their incoming set; a
+ * server-side cursor hands these over FETCHSZ rows at a time, so that
+ * the whole set is never held in memory, and the rest of it is never
+ * sent if the callback stops early.  Cursors only exist inside of a
+ * transaction, so the connection is held for the whole walk.
+ */
+bool ODBCAtomStorage::foreachIncoming(const Handle& h, Type t, bool subclass,
+                         const std::function<bool(const Handle&)>& cb)
+{
+    setup_typemap();
+
+    UUID uuid = _tlbuf.addAtom(h, TLB::INVALID_UUID);
+    std::string query =
+        "DECLARE incoming_cursor NO SCROLL CURSOR FOR "
+        "SELECT * FROM Atoms WHERE outgoing @> ARRAY[CAST(";
+    query += std::to_string(uuid);
+    query += " AS BIGINT)]";
+    query += typeFilter(t, subclass, storing_typemap);
+    query += ";";
+
+    char fetch[BUFSZ];
+    snprintf(fetch, BUFSZ,
+        "FETCH FORWARD %d FROM incoming_cursor;", FETCHSZ);
+
+    ODBCConnection* db_conn = get_conn();
+    Response rp;
+    rp.store = this;
+    rp.height = -1;
+
+    auto run = [&](const char* stmt) {
+        rp.rs = db_conn->exec(stmt);
+        rp.release();
+    };
+
+    bool stopped = false;
+    try
+    {
+        run("BEGIN;");
+        run(query.c_str());
+        while (not stopped)
+        {
+            HandleSeq batch;
+            rp.hvec = &batch;
+            rp.rs = db_conn->exec(fetch);
+
+            // No rows left.
+            if (nullptr == rp.rs) break;
+            rp.rs->foreach_row(&Response::fetch_incoming_set_cb, &rp);
+            rp.release();
+
+            for (const Handle& hi : batch)
+                if (cb(hi)) { stopped = true; break; }
+
+            if (batch.size() < FETCHSZ) break;
+        }
+        run("CLOSE incoming_cursor;");
+        run("COMMIT;");
+    }
+    catch (...)
+    {
+        rp.release();
+        run("ROLLBACK;");
+        put_conn(db_conn);
+        throw;
+    }
+    put_conn(db_conn);
+    return stopped;
+}
+
 /**
  * Fetch Node from database, with the indicated type and name.
  * If there is no such node, NULL is returned.
@@ -1375,6 +1459,139 @@ Handle ODBCAtomStorage::getLink(Handle& h)
     return h;
 }
 
+/* ================================================================ */
+// Batched fetches. Each of these issues one query per BATCHSZ atoms,
+// instead of one query per atom.
+
+#define BATCHSZ 500
+
+/// Run the query, and append every atom that it returns to hvec.
+void ODBCAtomStorage::getAtoms(const std::string& query, HandleSeq& hvec)
+{
+    ODBCConnection* db_conn = get_conn();
+    Response rp;
+    rp.store = this;
+    rp.height = -1;
+    rp.hvec = &hvec;
+    rp.rs = db_conn->exec(query.c_str());
+    rp.rs->foreach_row(&Response::fetch_incoming_set_cb, &rp);
+    rp.release();
+    put_conn(db_conn);
+}
+
+/// The database returns rows in no particular order; line them up
+/// with the atoms that were asked for.  Atoms are compared by content.
+static HandleSeq match_fetched(const HandleSeq& asked,
+                               const HandleSeq& fetched)
+{
+    std::unordered_map<Handle, Handle> by_content;
+    for (const Handle& h : fetched)
+        by_content.emplace(h, h);
+
+    HandleSeq found;
+    found.reserve(asked.size());
+    for (const Handle& h : asked)
+    {
+        auto it = by_content.find(h);
+        found.emplace_back(by_content.end() == it ? Handle() : it->second);
+    }
+    return found;
+}
+
+HandleSeq ODBCAtomStorage::getNodes(const HandleSeq& hs)
+{
+    setup_typemap();
+
+    HandleSeq fetched;
+    size_t nhs = hs.size();
+    for (size_t lo = 0; lo < nhs; lo += BATCHSZ)
+    {
+        size_t hi = std::min(lo + BATCHSZ, nhs);
+        std::string query = "SELECT * FROM Atoms WHERE ";
+        for (size_t i = lo; i < hi; i++)
+        {
+            char buff[BUFSZ];
+            snprintf(buff, BUFSZ, "(type = %hu AND name = $ocp$",
+                     storing_typemap[hs[i]->getType()]);
+            if (i != lo) query += " OR ";
+            query += buff;
+            query += hs[i]->getName();
+            query += "$ocp$)";
+        }
+        query += ";";
+        getAtoms(query, fetched);
+    }
+    return match_fetched(hs, fetched);
+}
+
+HandleSeq ODBCAtomStorage::getLinks(HandleSeq& hs)
+{
+    setup_typemap();
+
+    HandleSeq fetched;
+    size_t nhs = hs.size();
+    for (size_t lo = 0; lo < nhs; lo += BATCHSZ)
+    {
+        size_t hi = std::min(lo + BATCHSZ, nhs);
+        std::string query = "SELECT * FROM Atoms WHERE ";
+        for (size_t i = lo; i < hi; i++)
+        {
+            const HandleSeq& oset = hs[i]->getOutgoingSet();
+            char buff[BUFSZ];
+            snprintf(buff, BUFSZ, "(type = %hu AND outgoing = ",
+                     storing_typemap[hs[i]->getType()]);
+            if (i != lo) query += " OR ";
+            query += buff;
+            query += oset_to_string(oset, oset.size());
+            query += ")";
+        }
+        query += ";";
+        getAtoms(query, fetched);
+    }
+
+    // As in getLink(), hand back the caller's own links, with the
+    // stored truth values on them.
+    HandleSeq found(match_fetched(hs, fetched));
+    for (size_t i = 0; i < nhs; i++)
+    {
+        if (nullptr == found[i]) continue;
+        hs[i]->setTruthValue(found[i]->getTruthValue());
+        found[i] = hs[i];
+    }
+    return found;
+}
+
+/**
+ * Retreive the union of the incoming sets of the indicated atoms.
+ * The && (overlap) operator matches every link whose outgoing set
+ * contains at least one of the given atoms.
+ */
+HandleSeq ODBCAtomStorage::getIncomingSets(const HandleSeq& hs)
+{
+    setup_typemap();
+
+    HandleSeq fetched;
+    size_t nhs = hs.size();
+    for (size_t lo = 0; lo < nhs; lo += BATCHSZ)
+    {
+        size_t hi = std::min(lo + BATCHSZ, nhs);
+        HandleSeq chunk(hs.begin() + lo, hs.begin() + hi);
+        std::string query = "SELECT * FROM Atoms WHERE outgoing && ";
+        query += oset_to_string(chunk, chunk.size());
+        query += ";";
+        getAtoms(query, fetched);
+    }
+
+    // A link that holds atoms from different chunks was fetched
+    // more than once.
+    HandleSeq iset;
+    UnorderedHandleSet seen;
+    for (const Handle& h : fetched)
+        if (seen.insert(h).second)
+            iset.emplace_back(h);
+    return iset;
+}
+
 /**
  * Instantiate a new atom, from the response buffer contents
  */
@@ -87,6 +87,7 @@ class ODBCAtomStorage : public AtomStorage
         PseudoPtr makeAtom(Response &, UUID);
         PseudoPtr getAtom(const char *, int);
         PseudoPtr petAtom(UUID);
+        void getAtoms(const std::string&, HandleSeq&);
 
         int get_height(AtomPtr);
         int max_height;
@@ -153,6 +154,9 @@ class ODBCAtomStorage : public AtomStorage
         // Provider of asynchronous store of atoms.
         async_caller<ODBCAtomStorage, AtomPtr> _write_queue;
 
+    protected:
+        void forgetAtom(const Handle&);
+
     public:
         ODBCAtomStorage(const std::string& dbname, 
                     const std::string& username,
@@ -174,6 +178,11 @@ class ODBCAtomStorage : public AtomStorage
         Handle getNode(Type, const char *);
         Handle getLink(Handle& h);
         HandleSeq getIncomingSet(const Handle&);
+        HandleSeq getNodes(const HandleSeq&);
+        HandleSeq getLinks(HandleSeq&);
+        HandleSeq getIncomingSets(const HandleSeq&);
+        bool foreachIncoming(const Handle&, Type, bool,
+                             const std::function<bool(const Handle&)>&);
         void storeAtom(const AtomPtr& atomPtr, bool synchronous = false);
         void loadType(AtomTable&, Type);
         void flushStoreQueue();
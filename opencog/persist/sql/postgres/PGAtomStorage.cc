@@ -31,9 +31,11 @@
 #include <stdlib.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <chrono>
 #include <memory>
 #include <thread>
+#include <unordered_map>
 #include <opencog/util/random.h>
 #include <opencog/util/oc_assert.h>
 #include <opencog/atoms/base/Atom.h>
@@ -67,9 +69,15 @@ using namespace opencog;
 // Chunk size for writes to Edges table.
 #define EDGE_CHUNK 10000
 
-// Normal edge cache maximum. We use more for bulk loading but for the
-// normal case we only need to cache for a full depth get.
-#define EDGE_CACHE_MAX_SIZE 1000
+// Number of atoms asked for by one batched fetch query.
+#define BATCH_CHUNK 500
+
+// Number of rows pulled from a cursor in one round trip.
+#define FETCH_CHUNK 500
+
+// Edge cache maximum. Bulk loading caches the edges of a whole
+// LOAD_CHUNK of atoms at once, so the cache must hold that many.
+#define EDGE_CACHE_SIZE LOAD_CHUNK
 
 // Atom cache for handling nested atoms. Set to the expected number of
 // atoms to be retrieved as a result of a single get operation of a
@@ -630,7 +638,9 @@ void PGAtomStorage::init(const char * dbname,
 PGAtomStorage::PGAtomStorage(const char * dbname,
                          const char * username,
                          const char * authentication)
-    : _write_queue(this, &PGAtomStorage::vdo_store_atom)
+    : _write_queue(this, &PGAtomStorage::vdo_store_atom),
+      _edge_cache(EDGE_CACHE_SIZE),
+      _atom_cache(ATOM_CACHE_SIZE)
 {
     init(dbname, username, authentication);
 }
@@ -638,7 +648,9 @@ PGAtomStorage::PGAtomStorage(const char * dbname,
 PGAtomStorage::PGAtomStorage(const std::string& dbname,
                          const std::string& username,
                          const std::string& authentication)
-    : _write_queue(this, &PGAtomStorage::vdo_store_atom)
+    : _write_queue(this, &PGAtomStorage::vdo_store_atom),
+      _edge_cache(EDGE_CACHE_SIZE),
+      _atom_cache(ATOM_CACHE_SIZE)
 {
     init(dbname.c_str(), username.c_str(), authentication.c_str());
 }
@@ -1445,11 +1457,9 @@ void PGAtomStorage::get_ids(void)
 
 void PGAtomStorage::get_outgoing_edges(UUID uuid, std::vector<UUID>& outgoing)
 {
-    auto search = _edge_cache.find(uuid);
-    if(search != _edge_cache.end())
+    if (_edge_cache.get(uuid, outgoing))
     {
         // fprintf(stdout, "get_outgoing_edges - found %lu\n", uuid);
-        outgoing = search->second;
     }
     else
     {
@@ -1492,14 +1502,9 @@ void PGAtomStorage::get_outgoing_edges(UUID uuid, std::vector<UUID>& outgoing)
         }
 
         // Cache the outgoing edges for this uuid since we may need it right
-        // away if we're looking for collisions.
-
-        // Make room if the cache is full.
-        if (_edge_cache.size() >= EDGE_CACHE_MAX_SIZE)
-            _edge_cache.erase(_edge_cache.begin());
-
-        // Add this outgoing to the cache.
-        _edge_cache.emplace(uuid, outgoing);
+        // away if we're looking for collisions. The cache makes room for
+        // it by dropping the least recently used entry.
+        _edge_cache.put(uuid, outgoing);
     }
 }
 
@@ -1552,28 +1557,42 @@ PGAtomStorage::PseudoPtr PGAtomStorage::load_pseudo_atom_with_uuid(UUID uuid)
 
 void PGAtomStorage::cache_atom(UUID uuid, AtomPtr atom)
 {
-    // Remove an atom if we've reached the cache size.
-    if (_atom_cache.size() > ATOM_CACHE_SIZE)
-        _atom_cache.erase(_atom_cache.begin());
-
-    // Add the new atom to the cache.
-    _atom_cache.emplace(uuid, atom);
+    // Add the new atom to the cache, evicting the least recently
+    // used one if we've reached the cache size.
+    _atom_cache.put(uuid, atom);
 }
 
 AtomPtr PGAtomStorage::get_cached_atom(UUID uuid)
 {
-    // Remove an atom if we've reached the cache size.
-     auto search = _atom_cache.find(uuid);
-    if(search != _atom_cache.end())
+    AtomPtr atom;
+    if (_atom_cache.get(uuid, atom))
     {
         // fprintf(stdout, "get_cached_atom - found %lu\n", uuid);
-        return search->second;
+        return atom;
     }
 
     // We didn't find the UUID..
     return NULL;
 }
 
+/**
+ * The atom has been evicted from the AtomSpace; drop our references
+ * to it, so that its RAM can be reclaimed.  It will be re-fetched,
+ * with the same UUID, if it is ever asked for again.
+ */
+void PGAtomStorage::forgetAtom(const Handle& h)
+{
+    // An atom that was never given a UUID has nothing to forget; do
+    // not issue it one just to drop it again.
+    UUID uuid = TLB::getUUID(h);
+    if (TLB::INVALID_UUID == uuid)
+        return;
+
+    _atom_cache.erase(uuid);
+    _edge_cache.erase(uuid);
+    TLB::removeAtom(h);
+}
+
 
 /**
  * Retreive the entire incoming set of the indicated atom.
@@ -1615,6 +1634,75 @@ HandleSeq PGAtomStorage::getIncomingSet(const Handle& h)
     return incoming_set;
 }
 
+/**
+ * Stream the incoming set of the indicated atom to the callback.
+ * Hub atoms can have millions of links in their incoming set; a
+ * server-side cursor hands these over FETCH_CHUNK rows at a time, so
+ * that the whole set is never held in memory, and the rest of it is
+ * never sent if the callback stops early.  Cursors only exist inside
+ * of a transaction, so the connection is held for the whole walk.
+ */
+bool PGAtomStorage::foreachIncoming(const Handle& h, Type t, bool subclass,
+                         const std::function<bool(const Handle&)>& cb)
+{
+    Database database(this);
+
+    UUID uuid = TLB::addAtom(h, TLB::INVALID_UUID);
+    std::string query =
+        "DECLARE incoming_cursor NO SCROLL CURSOR FOR SELECT * FROM Atoms ";
+    if (_store_edges)
+    {
+        query += "WHERE uuid IN (SELECT src_uuid FROM Edges WHERE dst_uuid = ";
+        query += std::to_string(uuid);
+        query += ")";
+    }
+    else
+    {
+        query += "WHERE outgoing @> ARRAY[CAST(";
+        query += std::to_string(uuid);
+        query += " AS BIGINT)]";
+    }
+    query += typeFilter(t, subclass, _storing_type_map);
+    query += ";";
+
+    char fetch[BUFFER_SIZE];
+    snprintf(fetch, BUFFER_SIZE,
+            "FETCH FORWARD %d FROM incoming_cursor;", FETCH_CHUNK);
+
+    bool stopped = false;
+    try
+    {
+        database.execute("BEGIN;");
+        database.execute(query.c_str());
+        database.height = -1;
+        while (not stopped)
+        {
+            HandleSeq batch;
+            database.hvec = &batch;
+            database.execute(fetch);
+
+            // No rows left.
+            if (not database.has_results())
+                break;
+            database.for_each_row(&Database::fetch_incoming_set_cb);
+
+            for (const Handle& hi : batch)
+                if (cb(hi)) { stopped = true; break; }
+
+            if (batch.size() < FETCH_CHUNK)
+                break;
+        }
+        database.execute("CLOSE incoming_cursor;");
+        database.execute("COMMIT;");
+    }
+    catch (...)
+    {
+        database.execute("ROLLBACK;");
+        throw;
+    }
+    return stopped;
+}
+
 /**
  * Fetch Node from database, with the indicated type and name.
  * If there is no such node, NULL is returned.
@@ -1756,6 +1844,163 @@ Handle PGAtomStorage::getLink(Handle& h)
     return Handle(link);
 }
 
+/* ================================================================ */
+// Batched fetches. Each of these issues one query per BATCH_CHUNK
+// atoms, instead of one query per atom.
+
+/// Run the query, and append every atom that it returns to atoms.
+void PGAtomStorage::load_atoms(const std::string& statement, HandleSeq& atoms)
+{
+    Database database(this);
+    database.height = -1;
+    database.hvec = &atoms;
+    database.execute(statement.c_str());
+    database.for_each_row(&Database::fetch_incoming_set_cb);
+}
+
+/// The database returns rows in no particular order; line them up
+/// with the atoms that were asked for.  Atoms are compared by content.
+static HandleSeq match_loaded(const HandleSeq& requested,
+                              const HandleSeq& loaded)
+{
+    std::unordered_map<Handle, Handle> by_content;
+    for (const Handle& h : loaded)
+        by_content.emplace(h, h);
+
+    HandleSeq found;
+    found.reserve(requested.size());
+    for (const Handle& h : requested)
+    {
+        auto search = by_content.find(h);
+        found.emplace_back(search == by_content.end() ?
+                           Handle() : search->second);
+    }
+    return found;
+}
+
+HandleSeq PGAtomStorage::getNodes(const HandleSeq& nodes)
+{
+    HandleSeq loaded;
+    size_t node_count = nodes.size();
+    for (size_t start = 0; start < node_count; start += BATCH_CHUNK)
+    {
+        size_t end = std::min(start + BATCH_CHUNK, node_count);
+        std::string statement = "SELECT * FROM Atoms WHERE ";
+        for (size_t i = start; i < end; i++)
+        {
+            // Use postgres $-quoting to make unicode strings easier
+            // to deal with.
+            char clause[BUFFER_SIZE];
+            snprintf(clause, BUFFER_SIZE, "(type = %hu AND name = $ocp$",
+                     _storing_type_map[nodes[i]->getType()]);
+            if (i != start)
+                statement += " OR ";
+            statement += clause;
+            statement += nodes[i]->getName();
+            statement += "$ocp$)";
+        }
+        statement += ";";
+        load_atoms(statement, loaded);
+    }
+    return match_loaded(nodes, loaded);
+}
+
+HandleSeq PGAtomStorage::getLinks(HandleSeq& links)
+{
+    HandleSeq found;
+    size_t link_count = links.size();
+
+    // With an Edges table, links are found by outgoing-set hash, with
+    // collision checks for each candidate row; that does not batch.
+    if (_store_edges)
+        found = AtomStorage::getLinks(links);
+    else
+        found = load_links(links);
+
+    // Either way, hand back the caller's own links, with the stored
+    // truth values on them, as ODBCAtomStorage::getLinks() does.
+    for (size_t i = 0; i < link_count; i++)
+    {
+        if (nullptr == found[i])
+            continue;
+        links[i]->setTruthValue(found[i]->getTruthValue());
+        found[i] = links[i];
+    }
+    return found;
+}
+
+/**
+ * Load the stored versions of the links, a chunk of them per query.
+ * The result has the same length as the argument, with NULL for the
+ * links not in storage.
+ */
+HandleSeq PGAtomStorage::load_links(const HandleSeq& links)
+{
+    HandleSeq loaded;
+    size_t link_count = links.size();
+    for (size_t start = 0; start < link_count; start += BATCH_CHUNK)
+    {
+        size_t end = std::min(start + BATCH_CHUNK, link_count);
+        std::string statement = "SELECT * FROM Atoms WHERE ";
+        for (size_t i = start; i < end; i++)
+        {
+            char clause[BUFFER_SIZE];
+            snprintf(clause, BUFFER_SIZE, "(type = %hu AND outgoing = ",
+                     _storing_type_map[links[i]->getType()]);
+            if (i != start)
+                statement += " OR ";
+            statement += clause;
+            statement += outgoing_set_to_string(links[i]->getOutgoingSet());
+            statement += ")";
+        }
+        statement += ";";
+        load_atoms(statement, loaded);
+    }
+    return match_loaded(links, loaded);
+}
+
+/**
+ * Retreive the union of the incoming sets of the indicated atoms.
+ */
+HandleSeq PGAtomStorage::getIncomingSets(const HandleSeq& atoms)
+{
+    HandleSeq loaded;
+    size_t atom_count = atoms.size();
+    for (size_t start = 0; start < atom_count; start += BATCH_CHUNK)
+    {
+        size_t end = std::min(start + BATCH_CHUNK, atom_count);
+        HandleSeq chunk(atoms.begin() + start, atoms.begin() + end);
+        std::string uuids = outgoing_set_to_string(chunk);
+
+        // The && (overlap) operator matches every link whose outgoing
+        // set contains at least one of the atoms in the chunk.
+        std::string statement;
+        if (_store_edges)
+        {
+            statement = "SELECT * FROM Atoms WHERE uuid IN "
+                "(SELECT src_uuid FROM Edges WHERE dst_uuid = ANY(";
+            statement += uuids;
+            statement += "));";
+        }
+        else
+        {
+            statement = "SELECT * FROM Atoms WHERE outgoing && ";
+            statement += uuids;
+            statement += ";";
+        }
+        load_atoms(statement, loaded);
+    }
+
+    // A link that holds atoms from different chunks was loaded
+    // more than once.
+    HandleSeq incoming_set;
+    UnorderedHandleSet seen;
+    for (const Handle& h : loaded)
+        if (seen.insert(h).second)
+            incoming_set.emplace_back(h);
+    return incoming_set;
+}
+
 /**
  * Instantiate a new atom, from the response buffer contents
  */
@@ -1920,7 +2165,7 @@ void PGAtomStorage::cache_edges_where(const char * where_clause)
             if (last_source_uuid != NO_UUID)
             {
                 // Add the last uuid and outgoing vector to the cache.
-                _edge_cache.emplace(last_source_uuid, outgoing);
+                _edge_cache.put(last_source_uuid, outgoing);
 
                 // Clear the outgoing for the next uuid.
                 outgoing.clear();
@@ -1954,7 +2199,7 @@ void PGAtomStorage::cache_edges_where(const char * where_clause)
     if (last_source_uuid != NO_UUID)
     {
         // Add the last uuid and outgoing vector to the cache.
-        _edge_cache.emplace(last_source_uuid, outgoing);
+        _edge_cache.put(last_source_uuid, outgoing);
     }
 }
 
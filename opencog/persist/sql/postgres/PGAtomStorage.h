@@ -39,6 +39,7 @@
 #include <opencog/atoms/base/types.h>
 
 #include <opencog/atomspace/AtomTable.h>
+#include <opencog/atomspaceutils/LRUCache.h>
 
 #include <opencog/persist/sql/AtomStorage.h>
 #include <opencog/persist/sql/postgres/odbcxx.h>
@@ -88,6 +89,8 @@ class PGAtomStorage : public AtomStorage
         PseudoPtr make_pseudo_atom(Database&, UUID);
         PseudoPtr load_pseudo_atom(const char *, int);
         PseudoPtr load_pseudo_atom_with_uuid(UUID);
+        void load_atoms(const std::string&, HandleSeq&);
+        HandleSeq load_links(const HandleSeq&);
 
         // Atom height
         int get_height(AtomPtr);
@@ -183,13 +186,19 @@ class PGAtomStorage : public AtomStorage
         int _transaction_chunk;
         uint64_t _hash_seed;
 
-        std::unordered_map<UUID, std::vector<UUID>> _edge_cache;
+        // Bounded caches of outgoing edges and of fetched atoms, so
+        // that a long-running server fetching on demand does not grow
+        // without limit.
+        LRUCache<UUID, std::vector<UUID>> _edge_cache;
 
         // Atom Caching for getAtom optimization...
-        std::unordered_map<UUID, AtomPtr> _atom_cache;
+        LRUCache<UUID, AtomPtr> _atom_cache;
         void cache_atom(UUID uuid, AtomPtr atom);
         AtomPtr get_cached_atom(UUID uuid);
 
+    protected:
+        void forgetAtom(const Handle&);
+
     public:
         PGAtomStorage(const std::string& dbname, 
                     const std::string& username,
@@ -231,6 +240,15 @@ class PGAtomStorage : public AtomStorage
         int queryCount()
             { return _query_count; }
 
+        size_t atomCacheHits()
+            { return _atom_cache.hits(); }
+        size_t atomCacheMisses()
+            { return _atom_cache.misses(); }
+        size_t edgeCacheHits()
+            { return _edge_cache.hits(); }
+        size_t edgeCacheMisses()
+            { return _edge_cache.misses(); }
+
         void setTransactionChunk(int transaction_chunk)
             { _transaction_chunk = transaction_chunk; }
 
@@ -245,6 +263,11 @@ class PGAtomStorage : public AtomStorage
         Handle getNode(Type, const char *);
         Handle getLink(Handle&);
         HandleSeq getIncomingSet(const Handle&);
+        HandleSeq getNodes(const HandleSeq&);
+        HandleSeq getLinks(HandleSeq&);
+        HandleSeq getIncomingSets(const HandleSeq&);
+        bool foreachIncoming(const Handle&, Type, bool,
+                             const std::function<bool(const Handle&)>&);
         void storeAtom(const AtomPtr&, bool synchronous = false);
         void loadType(AtomTable &, Type);
         void flushStoreQueue();
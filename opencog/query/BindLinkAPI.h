@@ -22,6 +22,8 @@
 #ifndef _OPENCOG_BINDLINK_API_H
 #define _OPENCOG_BINDLINK_API_H
 
+#include <functional>
+
 #include <opencog/atoms/base/Handle.h>
 #include <opencog/truthvalue/TruthValue.h>
 
@@ -35,6 +37,24 @@ TruthValuePtr satisfaction_link(AtomSpace*, const Handle&);
 Handle satisfying_set(AtomSpace*, const Handle&, size_t max_results=SIZE_MAX);
 Handle recognize(AtomSpace*, const Handle&);
 
+/// Called with each new result of a streaming query, as soon as it is
+/// found.  Return true to stop the search.
+typedef std::function<bool(const Handle&)> ResultCallback;
+
+/// Streaming versions of bindlink() and satisfying_set(): results are
+/// handed to the callback one at a time, and are never gathered into
+/// a SetLink.  The groundings of multi-variable patterns are passed as
+/// ListLinks that are not in the AtomSpace.  Returns the number of
+/// results passed on.
+///
+/// To give a query a deadline or a step budget, run it under an
+/// ExecControl; results found before the limit is hit have already
+/// been delivered when the RuntimeException is thrown.
+size_t bindlink_stream(AtomSpace*, const Handle&, ResultCallback,
+                       size_t max_results=SIZE_MAX);
+size_t satisfying_set_stream(AtomSpace*, const Handle&, ResultCallback,
+                             size_t max_results=SIZE_MAX);
+
 } // namespace opencog
 
 #endif // _OPENCOG_BINDLINK_API_H
@@ -42,86 +42,19 @@ using namespace opencog;
 #endif
 
 /* ======================================================== */
-// Cache for temp (transient) atomsapaces.  The evaluation of
-// expressions during pattern matching requires having a temporary
-// atomspace, treated as a scratch space to hold temporary results.
-// These are then discarded, after the match is confirmed or denied.
-// The issue is that creating an atomspace is CPU-intensive, so its
-// cheaper to just have a cache of empty atomspaces, hanging around,
-// and ready to go. The code in this section implements this.
-
-const bool TRANSIENT_SPACE = true;
-const int MAX_CACHED_TRANSIENTS = 8;
-
-// Allocated storage for the transient atomspace cache static variables.
-std::mutex DefaultPatternMatchCB::s_transient_cache_mutex;
-std::vector<AtomSpace*> DefaultPatternMatchCB::s_transient_cache;
-
-AtomSpace* DefaultPatternMatchCB::grab_transient_atomspace(AtomSpace* parent)
-{
-	AtomSpace* transient_atomspace = NULL;
-
-	// See if the cache has one...
-	if (s_transient_cache.size() > 0)
-	{
-		// Grab the mutex lock.
-		std::unique_lock<std::mutex> cache_lock(s_transient_cache_mutex);
-
-		// Check to make sure the cache still has one now that we have
-		// the mutex.
-		if (s_transient_cache.size() > 0)
-		{
-			// Pop the last transient atomspace off the cache stack.
-			transient_atomspace = s_transient_cache.back();
-			s_transient_cache.pop_back();
-
-			// Ready it for the new parent atomspace.
-			transient_atomspace->ready_transient(parent);
-		}
-	}
-
-	// If we didn't get one from the cache, then create a new one.
-	if (!transient_atomspace)
-		transient_atomspace = new AtomSpace(parent, TRANSIENT_SPACE);
-
-	return transient_atomspace;
-}
-
-void DefaultPatternMatchCB::release_transient_atomspace(AtomSpace* atomspace)
-{
-	bool atomspace_cached = false;
-
-	// If the cache is not full...
-	if (s_transient_cache.size() < MAX_CACHED_TRANSIENTS)
-	{
-		// Grab the mutex lock.
-		std::unique_lock<std::mutex> cache_lock(s_transient_cache_mutex);
-
-		// Check it again since we only now have the mutex locked.
-		if (s_transient_cache.size() < MAX_CACHED_TRANSIENTS)
-		{
-			// Clear this transient atomspace.
-			atomspace->clear_transient();
-
-			// Place this transient into the cache.
-			s_transient_cache.push_back(atomspace);
-
-			// The atomspace has been cached.
-			atomspace_cached = true;
-		}
-	}
-
-	// If we didn't cache the atomspace, then delete it.
-	if (!atomspace_cached)
-		delete atomspace;
-}
+// The evaluation of expressions during pattern matching requires
+// having a temporary atomspace, treated as a scratch space to hold
+// temporary results.  These are then discarded, after the match is
+// confirmed or denied.  Creating an atomspace is CPU-intensive, so
+// the scratch spaces come from the per-thread cache of empty ones
+// kept by the AtomSpace.
 
 /* ======================================================== */
 
 DefaultPatternMatchCB::DefaultPatternMatchCB(AtomSpace* as) :
 	_classserver(classserver())
 {
-	_temp_aspace = grab_transient_atomspace(as);
+	_temp_aspace = AtomSpace::grab_transient(as);
 	_instor = new Instantiator(_temp_aspace);
 
 	_connectives.insert(SEQUENTIAL_AND_LINK);
@@ -140,7 +73,7 @@ DefaultPatternMatchCB::~DefaultPatternMatchCB()
 	// If we have a transient atomspace, release it.
 	if (_temp_aspace)
 	{
-		release_transient_atomspace(_temp_aspace);
+		AtomSpace::release_transient(_temp_aspace);
 		_temp_aspace = NULL;
 	}
 
@@ -151,7 +84,7 @@ DefaultPatternMatchCB::~DefaultPatternMatchCB()
 #ifdef CACHED_IMPLICATOR
 void DefaultPatternMatchCB::ready(AtomSpace* as)
 {
-	_temp_aspace = grab_transient_atomspace(as);
+	_temp_aspace = AtomSpace::grab_transient(as);
 	_instor->ready(_temp_aspace);
 
 	_as = as;
@@ -167,7 +100,7 @@ void DefaultPatternMatchCB::clear()
 	_have_variables = false;
 	_pattern_body = Handle::UNDEFINED;
 
-	release_transient_atomspace(_temp_aspace);
+	AtomSpace::release_transient(_temp_aspace);
 	_temp_aspace = NULL;
 	_instor->clear();
 
@@ -185,6 +118,7 @@ void DefaultPatternMatchCB::set_pattern(const Variables& vars,
 	_have_variables = ! vars.varseq.empty();
 	_pattern_body = pat.body;
 	_globs = &pat.globby_terms;
+	_batch_tvs.clear();
 }
 
 /* ======================================================== */
@@ -626,6 +560,7 @@ bool DefaultPatternMatchCB::eval_term(const Handle& virt,
 	// EvaluationLink::do_evaluate() method should do this ??? Its a toss-up.
 
 	TruthValuePtr tvp;
+	std::unordered_map<Handle, TruthValuePtr>::const_iterator bit;
 	// The instantiator would have taken care of expanding out
 	// and executing any FunctionLinks and the like.  Just use
 	// the TV value on the resulting atom.
@@ -640,6 +575,12 @@ bool DefaultPatternMatchCB::eval_term(const Handle& virt,
 		gvirt = _as->add_atom(gvirt);
 		tvp = gvirt->getTruthValue();
 	}
+	else if (not _batch_tvs.empty() and
+	         _batch_tvs.end() != (bit = _batch_tvs.find(gvirt)))
+	{
+		// Already evaluated, as part of a batch.
+		tvp = bit->second;
+	}
 	else
 	{
 		_temp_aspace->clear();
@@ -677,6 +618,93 @@ bool DefaultPatternMatchCB::eval_term(const Handle& virt,
 
 /* ======================================================== */
 
+/// Collect the EvaluationLinks of vectorised GroundedPredicateNodes,
+/// that eval_sentence() would reach by way of the logical connectives.
+void DefaultPatternMatchCB::find_vectorised(const Handle& term,
+                                            HandleSeq& found)
+{
+	if (not term->isLink()) return;
+
+	Type tt = term->getType();
+	if (EVALUATION_LINK == tt)
+	{
+		if (2 == term->getArity() and
+		    EvaluationLink::is_vectorised(term->getOutgoingAtom(0)))
+			found.emplace_back(term);
+		return;
+	}
+
+	if (_connectives.end() == _connectives.find(tt)) return;
+	for (const Handle& h : term->getOutgoingSet())
+		find_vectorised(h, found);
+}
+
+/**
+ * Evaluate the vectorised predicates in `evals` for every grounding
+ * in `gnds_seq`, making just one call into python or scheme for each
+ * predicate.  The TV's are kept until the next batch, so that the
+ * eval_term() calls for these groundings need not cross into python
+ * or scheme at all.  Non-vectorised terms are left alone; they are
+ * evaluated one grounding at a time, as usual.
+ *
+ * The pattern matcher only offers batches for the evaluatable terms
+ * that join several components; those within a single component are
+ * still evaluated once per candidate.
+ */
+void DefaultPatternMatchCB::batch_evaluate_sentences(const HandleSeq& evals,
+                                                     const HandleMapSeq& gnds_seq)
+{
+	_batch_tvs.clear();
+
+	HandleSeq terms;
+	for (const Handle& ev : evals)
+		find_vectorised(ev, terms);
+
+	if (terms.empty() or gnds_seq.size() < 2) return;
+
+	for (const Handle& term : terms)
+	{
+		// Ground the term for each candidate. Identical groundings
+		// need only be evaluated once.
+		HandleSeq gterms;
+		HandleSeq arglists;
+		_temp_aspace->clear();
+		for (const HandleMap& gnds : gnds_seq)
+		{
+			Handle gterm(_instor->instantiate(term, gnds));
+			if (not _batch_tvs.emplace(gterm, nullptr).second) continue;
+
+			// do_evaluate_batch() forces the arguments, as do_evaluate()
+			// would; they must not be executed here as well.
+			gterms.emplace_back(gterm);
+			arglists.emplace_back(gterm->getOutgoingAtom(1));
+		}
+
+		std::vector<TruthValuePtr> tvs;
+		try
+		{
+			tvs = EvaluationLink::do_evaluate_batch(_temp_aspace,
+			                        term->getOutgoingAtom(0), arglists);
+		}
+		catch (const NotEvaluatableException& ex)
+		{
+			// The predicate cannot be batched after all; evaluate it
+			// one grounding at a time.  Any other error, such as one
+			// raised by the user function, is passed on, just as
+			// eval_term() would have: running the batch again, one
+			// at a time, would repeat its side effects.
+			for (const Handle& gterm : gterms)
+				_batch_tvs.erase(gterm);
+			continue;
+		}
+
+		for (size_t i = 0; i < gterms.size(); i++)
+			_batch_tvs[gterms[i]] = tvs[i];
+	}
+}
+
+/* ======================================================== */
+
 /**
  * This implements the evaluation of a classical boolean-logic
  * "sentence": a well-formed formula with no free variables,
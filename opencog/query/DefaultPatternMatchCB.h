@@ -25,6 +25,8 @@
 #ifndef _OPENCOG_DEFAULT_PATTERN_MATCH_H
 #define _OPENCOG_DEFAULT_PATTERN_MATCH_H
 
+#include <unordered_map>
+
 #include <opencog/atoms/base/types.h>
 #include <opencog/atoms/base/Quotation.h>
 #include <opencog/atomspace/AtomSpace.h>
@@ -67,6 +69,9 @@ class DefaultPatternMatchCB : public virtual PatternMatchCallback
 		virtual bool post_link_match(const Handle&, const Handle&);
 		virtual void post_link_mismatch(const Handle&, const Handle&);
 
+		// node_match() and link_match() above are exact.
+		virtual bool strict_match(void) { return true; }
+
 		virtual bool clause_match(const Handle&, const Handle&,
 		                          const HandleMap&);
 		/**
@@ -86,6 +91,15 @@ class DefaultPatternMatchCB : public virtual PatternMatchCallback
 		                           const std::map<Handle,Handle>& gnds)
 		{ return eval_sentence(pat, gnds); }
 
+		/**
+		 * Evaluates any vectorised GroundedPredicateNodes ("py-vec:"
+		 * and "scm-vec:") in the virtual links, for all of the
+		 * groundings in one call, and remembers the results for
+		 * evaluate_sentence().
+		 */
+		virtual void batch_evaluate_sentences(const HandleSeq&,
+		                                      const HandleMapSeq&);
+
 		virtual const std::set<Type>& get_connectives(void)
 		{
 			return _connectives;
@@ -115,22 +129,20 @@ class DefaultPatternMatchCB : public virtual PatternMatchCallback
 		const Variables* _gnd_bound_vars;
 
 		// Temp atomspace used for test-groundings of virtual links.
+		// It comes from AtomSpace::grab_transient(), and is cleared,
+		// not deleted, between evaluations.
 		AtomSpace* _temp_aspace;
 		Instantiator* _instor;
 
-		// The transient atomspace cache. The goal here is to
-		// avoid the overhead of constantly creating/deleting
-		// the temp atomspaces above. So instead, just keep a
-		// cache of empty ones, ready to go.
-		static std::mutex s_transient_cache_mutex;
-		static std::vector<AtomSpace*> s_transient_cache;
-		static AtomSpace* grab_transient_atomspace(AtomSpace* parent);
-		static void release_transient_atomspace(AtomSpace* atomspace);
-
 #ifdef CACHED_IMPLICATOR
 		virtual void ready(AtomSpace*);
 		virtual void clear();
 #endif
+		// TV's of vectorised predicates, evaluated in a batch ahead of
+		// time, keyed by the grounded EvaluationLink.
+		std::unordered_map<Handle, TruthValuePtr> _batch_tvs;
+		void find_vectorised(const Handle&, HandleSeq&);
+
 		// Crisp-logic evaluation of evaluatable terms
 		std::set<Type> _connectives;
 		bool eval_term(const Handle& pat,
@@ -22,6 +22,7 @@
  */
 
 #include <opencog/atomspace/AtomSpace.h>
+#include <opencog/atomutils/ExecControl.h>
 #include <opencog/atoms/pattern/BindLink.h>
 
 #include "BindLinkAPI.h"
@@ -54,14 +55,18 @@ bool Implicator::grounding(const HandleMap &var_soln,
 	// See issue #950 and pull req #962.  That is, we should NOT
 	// use a try-catch here to mask out user-errors -- user errors
 	// really should be reported to the user. But for now, this is
-	// needed. XXX FIXME later.
+	// needed. XXX FIXME later.  A cancelled or timed-out query must
+	// not be masked, though.
+	Handle h;
 	try {
-		Handle h = inst.instantiate(implicand, var_soln);
-		insert_result(h);
-	} catch(...) {}
+		h = inst.instantiate(implicand, var_soln);
+	} catch(...) {
+		ExecControl::check_current();
+	}
+	insert_result(h);
 
 	// If we found as many as we want, then stop looking for more.
-	return (_result_set.size() >= max_results);
+	return _stopped or (_result_set.size() >= max_results);
 }
 
 void Implicator::insert_result(const Handle& h)
@@ -69,7 +74,10 @@ void Implicator::insert_result(const Handle& h)
 	if (h and _result_set.end() == _result_set.find(h))
 	{
 		_result_set.insert(h);
-		_result_list.push_back(h);
+		if (on_result)
+			_stopped = on_result(h);
+		else
+			_result_list.push_back(h);
 	}
 }
 
@@ -100,7 +108,13 @@ static Handle do_imply(AtomSpace* as,
 
 	bl->imply(impl, do_conn_check);
 
+	// When streaming, the results have all been passed on already;
+	// but see the no-match case, below.
+	bool streaming = (nullptr != impl.on_result);
+
 	// If we got a non-empty answer, just return it.
+	if (streaming and 0 < impl.get_result_count())
+		return Handle::UNDEFINED;
 	if (0 < impl.get_result_list().size())
 	{
 		// The result_list contains a list of the grounded expressions.
@@ -133,6 +147,7 @@ static Handle do_imply(AtomSpace* as,
 		impl.insert_result(h);
 	}
 
+	if (streaming) return Handle::UNDEFINED;
 	return as->add_link(SET_LINK, impl.get_result_list());
 }
 
@@ -169,6 +184,20 @@ Handle af_bindlink(AtomSpace* as, const Handle& hbindlink)
 	return do_imply(as, hbindlink, impl, false);
 }
 
+/**
+ * Streaming bindlink: each result goes to the callback as soon as
+ * the implicand has been instantiated for it.
+ */
+size_t bindlink_stream(AtomSpace* as, const Handle& hbindlink,
+                       ResultCallback cb, size_t max_results)
+{
+	DefaultImplicator impl(as);
+	impl.max_results = max_results;
+	impl.on_result = cb;
+	do_imply(as, hbindlink, impl);
+	return impl.get_result_count();
+}
+
 }
 
 /* ===================== END OF FILE ===================== */
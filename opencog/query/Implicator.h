@@ -29,6 +29,7 @@
 #include <opencog/atomspace/AtomSpace.h>
 
 #include <opencog/atoms/execution/Instantiator.h>
+#include <opencog/query/BindLinkAPI.h>
 #include <opencog/query/PatternMatchCallback.h>
 
 
@@ -50,6 +51,9 @@ namespace opencog {
  * grounding.  A set of grounded expressions is created in 'result_set'.
  * Note that the callback may be called many times reporting the same
  * results. In that case the 'result_set' will contain unique solutions.
+ *
+ * If 'on_result' is set, each unique result is passed to it as soon as
+ * it is found, instead of being added to 'result_list'.
  */
 class Implicator :
 	public virtual PatternMatchCallback
@@ -57,16 +61,24 @@ class Implicator :
 	protected:
 		UnorderedHandleSet _result_set;
 		HandleSeq _result_list;
+		bool _stopped;
 
 	public:
-		Implicator(AtomSpace* as) : inst(as), max_results(SIZE_MAX) {}
+		Implicator(AtomSpace* as) :
+			_stopped(false), inst(as), max_results(SIZE_MAX) {}
 		Instantiator inst;
 		Handle implicand;
 		size_t max_results;
+		ResultCallback on_result;
 
 #ifdef CACHED_IMPLICATOR
 		virtual void ready(AtomSpace* asp)
-		{ inst.ready(asp); max_results = SIZE_MAX; }
+		{
+			inst.ready(asp);
+			max_results = SIZE_MAX;
+			on_result = nullptr;
+			_stopped = false;
+		}
 
 		virtual void clear()
 		{ inst.clear(); implicand = Handle::UNDEFINED; }
@@ -78,6 +90,7 @@ class Implicator :
 		virtual void insert_result(const Handle&);
 		virtual UnorderedHandleSet get_result_set() { return _result_set; }
 		virtual HandleSeq get_result_list() { return _result_list; }
+		size_t get_result_count() const { return _result_set.size(); }
 };
 
 }; // namespace opencog
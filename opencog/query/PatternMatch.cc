@@ -69,11 +69,19 @@ class PMCGroundings : public PatternMatchCallback
 		bool fuzzy_match(const Handle& h1, const Handle& h2) {
 			return _cb.fuzzy_match(h1, h2);
 		}
+		bool strict_match(void) {
+			return _cb.strict_match();
+		}
 		bool evaluate_sentence(const Handle& link_h,
 		                       const HandleMap &gnds)
 		{
 			return _cb.evaluate_sentence(link_h,gnds);
 		}
+		void batch_evaluate_sentences(const HandleSeq& evals,
+		                              const HandleMapSeq& gnds_seq)
+		{
+			_cb.batch_evaluate_sentences(evals, gnds_seq);
+		}
 		bool clause_match(const Handle& pattrn_link_h,
 		                  const Handle& grnd_link_h,
 		                  const HandleMap& term_gnds)
@@ -219,17 +227,40 @@ bool PatternMatch::recursive_virtual(PatternMatchCallback& cb,
 	comp_term_gnds.pop_back();
 
 	size_t ngnds = vg.size();
+
+	// If this is the last component, then every one of its groundings
+	// is a complete candidate, about to be run through the virtual
+	// clauses. Offer all of them to the callback in one batch, so that
+	// it can amortise the cost of evaluating them.
+	HandleMapSeq batch;
+	if (comp_var_gnds.empty() and 0 < virtuals.size())
+	{
+		batch.reserve(ngnds);
+		for (size_t i=0; i<ngnds; i++)
+		{
+			batch.emplace_back(var_gnds);
+			batch.back().insert(vg[i].begin(), vg[i].end());
+		}
+		cb.batch_evaluate_sentences(virtuals, batch);
+	}
+
 	for (size_t i=0; i<ngnds; i++)
 	{
 		// Given a set of groundings, tack on those for this component,
 		// and recurse, with one less component. We need to make a copy,
 		// of course.
-		HandleMap rvg(var_gnds);
+		HandleMap rvg;
 		HandleMap rpg(term_gnds);
 
-		const HandleMap& cand_vg(vg[i]);
+		if (batch.empty())
+		{
+			rvg = var_gnds;
+			rvg.insert(vg[i].begin(), vg[i].end());
+		}
+		else
+			rvg.swap(batch[i]);
+
 		const HandleMap& cand_pg(pg[i]);
-		rvg.insert(cand_vg.begin(), cand_vg.end());
 		rpg.insert(cand_pg.begin(), cand_pg.end());
 
 		bool accept = recursive_virtual(cb, virtuals, negations, rvg, rpg,
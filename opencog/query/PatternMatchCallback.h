@@ -158,6 +158,21 @@ class PatternMatchCallback
 			return false;
 		}
 
+		/**
+		 * Return true if node_match() accepts only identical nodes,
+		 * link_match() accepts only links of the same type as the
+		 * pattern (or anything at all, for a ChoiceLink), and
+		 * fuzzy_match() accepts nothing.  The engine then knows,
+		 * without asking, that some terms of an unordered link can
+		 * never be grounded by some of the candidate's atoms, and
+		 * skips the permutations that would pair them.  Callbacks
+		 * that loosen any of the above must return false.
+		 */
+		virtual bool strict_match(void)
+		{
+			return false;
+		}
+
 		/**
 		 * Invoked to confirm or deny a candidate grounding for term that
 		 * consistes entirely of connectives and evaluatable terms.
@@ -212,6 +227,19 @@ class PatternMatchCallback
 		virtual bool evaluate_sentence(const Handle& eval,
 		                      const std::map<Handle,Handle>& gnds) = 0;
 
+		/**
+		 * Called with a batch of candidate groundings, before they are
+		 * passed, one at a time, to evaluate_sentence(). The 'evals'
+		 * are the evaluatable terms, and 'gnds_seq' holds one proposed
+		 * grounding per candidate. This is only a hint: it allows
+		 * an implementation to evaluate the whole batch at once, and
+		 * to answer the following evaluate_sentence() calls from the
+		 * results.  The default does nothing.
+		 */
+		virtual void batch_evaluate_sentences(const HandleSeq& evals,
+		                                      const HandleMapSeq& gnds_seq)
+		{}
+
 		/**
 		 * Called when a top-level clause has been fully grounded.
 		 * This is meant to be used for evaluating the truth value
@@ -21,6 +21,8 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <algorithm>
+
 #include <opencog/util/oc_assert.h>
 #include <opencog/util/Logger.h>
 #include <opencog/atomutils/FindUtils.h>
@@ -44,6 +46,9 @@ using namespace opencog;
  */
 /* ======================================================== */
 
+// How often, in tree comparisons, the ExecControl is polled.
+static const unsigned int CONTROL_STEPS = 64;
+
 // The macro POPSTK has an OC_ASSERT when DEBUG is defined, so we keep
 // that #define around, although it's not clear why that OC_ASSERT
 // wouldn't be kept no matter what (it's not like it's gonna take up a
@@ -76,6 +81,15 @@ static inline void log(const Handle& h) {}
 #endif
 
 
+/// The grounding of h, or UNDEFINED. Unlike operator[], this does
+/// not add an entry behind the back of the solution trail.
+static inline Handle lookup(const HandleMap& map, const Handle& h)
+{
+	auto gnd = map.find(h);
+	if (map.end() == gnd) return Handle::UNDEFINED;
+	return gnd->second;
+}
+
 /* ======================================================== */
 /* Reset the current variable grounding to the last grounding pushed
  * onto the stack. */
@@ -130,7 +144,7 @@ bool PatternMatchEngine::variable_compare(const Handle& hp,
 	DO_LOG({LAZY_LOG_FINE << "Found grounding of variable:";})
 	logmsg("$$ variable:", hp);
 	logmsg("$$ ground term:", hg);
-	if (hp->getType() != GLOB_NODE) var_grounding[hp] = hg;
+	if (hp->getType() != GLOB_NODE) set_grounding(var_grounding, hp, hg);
 	return true;
 }
 
@@ -145,7 +159,7 @@ bool PatternMatchEngine::variable_compare(const Handle& hp,
 bool PatternMatchEngine::self_compare(const PatternTermPtr& ptm)
 {
 	const Handle& hp = ptm->getHandle();
-	if (not ptm->isQuoted()) var_grounding[hp] = hp;
+	if (not ptm->isQuoted()) set_grounding(var_grounding, hp, hp);
 
 	logmsg("Compare atom to itself:", hp);
 	return true;
@@ -164,7 +178,7 @@ bool PatternMatchEngine::node_compare(const Handle& hp,
 		DO_LOG({LAZY_LOG_FINE << "Found matching nodes";})
 		logmsg("# pattern:", hp);
 		logmsg("# match:", hg);
-		if (hp != hg) var_grounding[hp] = hg;
+		if (hp != hg) set_grounding(var_grounding, hp, hg);
 	}
 	return match;
 }
@@ -283,7 +297,7 @@ bool PatternMatchEngine::ordered_compare(const PatternTermPtr& ptm,
 
 				// If we are here, we've got a match; record the glob.
 				LinkPtr glp(createLink(LIST_LINK, glob_seq));
-				var_grounding[glob->getHandle()] = glp->getHandle();
+				set_grounding(var_grounding, glob->getHandle(), glp->getHandle());
 			}
 			else
 			{
@@ -314,7 +328,7 @@ bool PatternMatchEngine::ordered_compare(const PatternTermPtr& ptm,
 	if (not match) return false;
 
 	// If we've found a grounding, record it.
-	if (hp != hg) var_grounding[hp] = hg;
+	if (hp != hg) set_grounding(var_grounding, hp, hg);
 
 	return true;
 }
@@ -373,7 +387,7 @@ bool PatternMatchEngine::choice_compare(const PatternTermPtr& ptm,
 				solution_drop();
 
 				// If the grounding is accepted, record it.
-				if (hp != hg) var_grounding[hp] = hg;
+				if (hp != hg) set_grounding(var_grounding, hp, hg);
 
 				_choice_state[GndChoice(ptm, hg)] = icurr;
 				return true;
@@ -559,6 +573,174 @@ they call compare_tree.
 
 ******************************************************************/
 
+/// Cheap test of whether the pattern term could possibly be grounded
+/// by hg, made without calling tree_compare(), which has side effects.
+/// It errs on the side of yes: it looks only at groundings already
+/// made, and, if the callback matches strictly, at link types and
+/// node identity.  This mirrors the order of tests in tree_compare().
+bool PatternMatchEngine::term_fits(const PatternTermPtr& ptm,
+                                   const Handle& hg, bool strict)
+{
+	const Handle& hp = ptm->getHandle();
+
+	// Groundings made earlier hold for every permutation, since each
+	// one starts out from the same solution_push().
+	auto gnd = var_grounding.find(hp);
+	if (gnd != var_grounding.end()) return (gnd->second == hg);
+
+	if (not strict) return true;
+
+	// Leave the not-implemented cases to throw, as before.
+	if (is_executable(hp)) return true;
+	Type tp = hp->getType();
+	if (DEFINED_SCHEMA_NODE == tp) return true;
+
+	// Variables are up to the variable_match() and scope_match()
+	// callbacks.
+	if (not ptm->isQuoted())
+	{
+		if (_varlist->varset.end() != _varlist->varset.find(hp))
+			return true;
+		if (VARIABLE_NODE == tp) return true;
+	}
+
+	if (hp == hg) return true;
+
+	// Distinct nodes fail node_match(); a node and a link fail
+	// fuzzy_match(), and links fail link_match() on a type mismatch.
+	if (hp->isNode() or hg->isNode()) return false;
+	if (CHOICE_LINK == tp) return true;
+	return tp == hg->getType();
+}
+
+/// Fit matrix of the sorted terms against the candidate's atoms.
+PatternMatchEngine::PermFit
+PatternMatchEngine::perm_fit(const PatternTermSeq& terms,
+                             const HandleSeq& osg)
+{
+	bool strict = _pmc.strict_match();
+	size_t arity = terms.size();
+	PermFit fit(arity, std::vector<bool>(arity));
+	for (size_t t=0; t<arity; t++)
+		for (size_t i=0; i<arity; i++)
+			fit[t][i] = term_fits(terms[t], osg[i], strict);
+	return fit;
+}
+
+/// Try to place term t on some position from `pos` on, moving terms
+/// already placed, if need be (an augmenting path, as in Kuhn's
+/// bipartite matching algorithm).
+bool PatternMatchEngine::augment(size_t t, const PermFit& fit,
+                                 size_t pos, std::vector<size_t>& owner,
+                                 std::vector<bool>& seen)
+{
+	for (size_t i=pos; i<owner.size(); i++)
+	{
+		if (not fit[t][i] or seen[i]) continue;
+		seen[i] = true;
+		if (SIZE_MAX == owner[i] or augment(owner[i], fit, pos, owner, seen))
+		{
+			owner[i] = t;
+			return true;
+		}
+	}
+	return false;
+}
+
+/// True if the terms not yet used can all be placed, on the positions
+/// from `pos` onwards, so that every one of them fits.
+bool PatternMatchEngine::can_complete(const PermFit& fit,
+                                      const std::vector<bool>& used,
+                                      size_t pos)
+{
+	size_t arity = used.size();
+	std::vector<size_t> owner(arity, SIZE_MAX);
+	for (size_t t=0; t<arity; t++)
+	{
+		if (used[t]) continue;
+		std::vector<bool> seen(arity, false);
+		if (not augment(t, fit, pos, owner, seen)) return false;
+	}
+	return true;
+}
+
+/// Step `order` to the lexicographically next ordering of the terms
+/// in which every term fits its position, or, if `first`, find the
+/// first such ordering. Return false if there is none.
+///
+/// Subtrees of orderings that cannot be completed are never entered:
+/// the bipartite-matching test above rejects a partial ordering as
+/// soon as the remaining terms cannot all be placed. Thus, constant
+/// terms get pinned to their atoms, and only terms of compatible
+/// types get shuffled among themselves.  When everything fits, this
+/// is just std::next_permutation().
+bool PatternMatchEngine::next_fit(std::vector<size_t>& order,
+                                  const PermFit& fit, bool first)
+{
+	size_t arity = order.size();
+	if (0 == arity) return false;
+
+	bool all_fit = true;
+	for (size_t t=0; all_fit and t<arity; t++)
+		for (size_t i=0; all_fit and i<arity; i++)
+			all_fit = fit[t][i];
+
+	if (all_fit)
+	{
+		if (first) return true;
+		return std::next_permutation(order.begin(), order.end());
+	}
+
+	// The longest prefix of the current ordering that fits.  Changing
+	// a position past the first misfit is pointless.
+	std::vector<bool> used(arity, false);
+	size_t fits = 0;
+	if (not first)
+	{
+		while (fits < arity-1 and fit[order[fits]][fits])
+			used[order[fits++]] = true;
+	}
+
+	// Find the last position that can be advanced, then fill in the
+	// rest of the ordering with the smallest terms that fit.
+	for (size_t k = fits+1; 0 < k; k--)
+	{
+		size_t pos = k-1;
+		if (pos < fits) used[order[pos]] = false;
+
+		size_t lo = first ? 0 : order[pos]+1;
+		for (size_t t=lo; t<arity; t++)
+		{
+			if (used[t] or not fit[t][pos]) continue;
+			used[t] = true;
+			if (not can_complete(fit, used, pos+1))
+			{
+				used[t] = false;
+				continue;
+			}
+
+			order[pos] = t;
+			for (size_t i=pos+1; i<arity; i++)
+			{
+				for (size_t u=0; u<arity; u++)
+				{
+					if (used[u] or not fit[u][i]) continue;
+					used[u] = true;
+					if (can_complete(fit, used, i+1))
+					{
+						order[i] = u;
+						break;
+					}
+					used[u] = false;
+				}
+			}
+			return true;
+		}
+		if (first) return false;
+	}
+	return false;
+}
+
 bool PatternMatchEngine::unorder_compare(const PatternTermPtr& ptm,
                                          const Handle& hg)
 {
@@ -581,6 +763,25 @@ bool PatternMatchEngine::unorder_compare(const PatternTermPtr& ptm,
 	Permutation mutation = curr_perm(ptm, hg, fresh);
 	if (fresh) take_step = false; // took a step, clear the flag.
 
+	// Permutations are stepped through as orderings of the sorted
+	// terms, skipping those that put a term on an atom that it
+	// cannot possibly match.
+	PatternTermSeq terms(osp);
+	sort(terms.begin(), terms.end());
+	PermFit fit(perm_fit(terms, osg));
+	std::vector<size_t> order(arity);
+	for (size_t i=0; i<arity; i++)
+		order[i] = std::lower_bound(terms.begin(), terms.end(), mutation[i])
+		           - terms.begin();
+
+	if (fresh and not next_fit(order, fit, true))
+	{
+		DO_LOG({LAZY_LOG_FINE << "No permutation fits term=" << ptm->toString();})
+		_pmc.post_link_mismatch(hp, hg);
+		have_more = false;
+		return false;
+	}
+
 	// Cases C and D fall through.
 	// If we are here, we've got possibilities to explore.
 #ifdef DEBUG
@@ -596,6 +797,9 @@ bool PatternMatchEngine::unorder_compare(const PatternTermPtr& ptm,
 #endif
 	do
 	{
+		for (size_t i=0; i<arity; i++)
+			mutation[i] = terms[order[i]];
+
 		DO_LOG({LAZY_LOG_FINE << "tree_comp explore unordered perm "
 		              << perm_count[Unorder(ptm, hg)] << " of " << num_perms
 		              << " of term=" << ptm->toString();})
@@ -643,7 +847,7 @@ bool PatternMatchEngine::unorder_compare(const PatternTermPtr& ptm,
 				solution_drop();
 
 				// If the grounding is accepted, record it.
-				if (hp != hg) var_grounding[hp] = hg;
+				if (hp != hg) set_grounding(var_grounding, hp, hg);
 
 				// Handle case 5&7 of description above.
 				have_more = true;
@@ -669,7 +873,7 @@ take_next_step:
 		solution_pop();
 		if (logger().is_fine_enabled())
 			perm_count[Unorder(ptm, hg)] ++;
-	} while (std::next_permutation(mutation.begin(), mutation.end()));
+	} while (next_fit(order, fit, false));
 
 	// If we are here, we've explored all the possibilities already
 	DO_LOG({LAZY_LOG_FINE << "Exhausted all permuations of term=" << ptm->toString();})
@@ -777,6 +981,10 @@ bool PatternMatchEngine::tree_compare(const PatternTermPtr& ptm,
 {
 	const Handle& hp = ptm->getHandle();
 
+	// Now and then, see if the search should be abandoned.
+	if (_control and 0 == ++_steps % CONTROL_STEPS)
+		_control->step(CONTROL_STEPS);
+
 	// Do we already have a grounding for this? If we do, and the
 	// proposed grounding is the same as before, then there is
 	// nothing more to do.
@@ -1295,7 +1503,7 @@ bool PatternMatchEngine::clause_accept(const Handle& clause_root,
 
 	if (not is_evaluatable(clause_root))
 	{
-		clause_grounding[clause_root] = hg;
+		set_grounding(clause_grounding, clause_root, hg);
 		logmsg("---------------------\nclause:", clause_root);
 		logmsg("ground:", hg);
 	}
@@ -1331,7 +1539,7 @@ bool PatternMatchEngine::do_next_clause(void)
 		              << (is_evaluatable(curr_root)?
 		                  "dynamically evaluatable" : "non-dynamic");
 		logmsg("Joining variable is", joiner);
-		logmsg("Joining grounding is", var_grounding[joiner]); })
+		logmsg("Joining grounding is", lookup(var_grounding, joiner)); })
 
 		// Else, start solving the next unsolved clause. Note: this is
 		// a recursive call, and not a loop. Recursion is halted when
@@ -1343,7 +1551,7 @@ bool PatternMatchEngine::do_next_clause(void)
 		// else the join is a 'real' atom.
 
 		clause_accepted = false;
-		Handle hgnd = var_grounding[joiner];
+		Handle hgnd = lookup(var_grounding, joiner);
 		OC_ASSERT(hgnd != nullptr,
 			"Error: joining handle has not been grounded yet!");
 		found = explore_clause(joiner, hgnd, curr_root);
@@ -1372,7 +1580,7 @@ bool PatternMatchEngine::do_next_clause(void)
 			}
 
 			// XXX Maybe should push n pop here? No, maybe not ...
-			clause_grounding[curr_root] = Handle::UNDEFINED;
+			set_grounding(clause_grounding, curr_root, Handle::UNDEFINED);
 			get_next_untried_clause();
 			joiner = next_joint;
 			curr_root = next_clause;
@@ -1390,7 +1598,7 @@ bool PatternMatchEngine::do_next_clause(void)
 				// or not. If it does, we'll recurse. If it does not,
 				// we'll loop around back to here again.
 				clause_accepted = false;
-				Handle hgnd = var_grounding[joiner];
+				Handle hgnd = lookup(var_grounding, joiner);
 				found = explore_term_branches(joiner, hgnd, curr_root);
 			}
 		}
@@ -1597,7 +1805,7 @@ bool PatternMatchEngine::get_next_thinnest_clause(bool search_virtual,
 
 		if (unsolved_clause)
 		{
-			issued.insert(unsolved_clause);
+			issue(unsolved_clause);
 			return true;
 		}
 	}
@@ -1626,10 +1834,8 @@ void PatternMatchEngine::clause_stacks_push(void)
 	DO_LOG({logger().fine("--- That's it, now push to stack depth=%d",
 	              _clause_stack_depth);})
 
-	var_solutn_stack.push(var_grounding);
-	term_solutn_stack.push(clause_grounding);
-
-	issued_stack.push(issued);
+	solution_push();
+	issued_marks.push_back(issued_trail.size());
 	choice_stack.push(_choice_state);
 
 	perm_push();
@@ -1647,10 +1853,16 @@ void PatternMatchEngine::clause_stacks_pop(void)
 {
 	_pmc.pop();
 
-	// The grounding stacks are handled differently.
-	POPSTK(term_solutn_stack, clause_grounding);
-	POPSTK(var_solutn_stack, var_grounding);
-	POPSTK(issued_stack, issued);
+	solution_pop();
+
+	OC_ASSERT(not issued_marks.empty(), "Unbalanced issued trail");
+	size_t mark = issued_marks.back();
+	issued_marks.pop_back();
+	while (mark < issued_trail.size())
+	{
+		issued.erase(issued_trail.back());
+		issued_trail.pop_back();
+	}
 
 	POPSTK(choice_stack, _choice_state);
 
@@ -1672,36 +1884,81 @@ void PatternMatchEngine::clause_stacks_clear(void)
 {
 	_clause_stack_depth = 0;
 #if 0
-	OC_ASSERT(0 == term_solutn_stack.size());
-	OC_ASSERT(0 == var_solutn_stack.size());
-	OC_ASSERT(0 == issued_stack.size());
+	OC_ASSERT(0 == solutn_marks.size());
+	OC_ASSERT(0 == issued_marks.size());
 	OC_ASSERT(0 == choice_stack.size());
 	OC_ASSERT(0 == perm_stack.size());
 #else
-	while (!term_solutn_stack.empty()) term_solutn_stack.pop();
-	while (!var_solutn_stack.empty()) var_solutn_stack.pop();
-	while (!issued_stack.empty()) issued_stack.pop();
+	solutn_marks.clear();
+	solutn_trail.clear();
+	issued_marks.clear();
+	issued_trail.clear();
 	while (!choice_stack.empty()) choice_stack.pop();
 	while (!perm_stack.empty()) perm_stack.pop();
 #endif
 }
 
+/// Record a grounding, logging what it replaces on the trail.
+/// Nothing is logged when there is no mark to undo back to.
+void PatternMatchEngine::set_grounding(HandleMap& map,
+                                       const Handle& key,
+                                       const Handle& val)
+{
+	auto it = map.find(key);
+	if (map.end() == it)
+	{
+		if (not solutn_marks.empty())
+			solutn_trail.push_back({&map, key, Handle::UNDEFINED, false});
+		map.emplace(key, val);
+		return;
+	}
+
+	if (it->second == val) return;
+	if (not solutn_marks.empty())
+		solutn_trail.push_back({&map, key, it->second, true});
+	it->second = val;
+}
+
+/// Undo the changes logged since the mark, newest first.
+void PatternMatchEngine::solution_undo(size_t mark)
+{
+	while (mark < solutn_trail.size())
+	{
+		Binding& b = solutn_trail.back();
+		if (b.had_prev)
+			(*b.map)[b.key] = b.prev;
+		else
+			b.map->erase(b.key);
+		solutn_trail.pop_back();
+	}
+}
+
 void PatternMatchEngine::solution_push(void)
 {
-	var_solutn_stack.push(var_grounding);
-	term_solutn_stack.push(clause_grounding);
+	solutn_marks.push_back(solutn_trail.size());
 }
 
 void PatternMatchEngine::solution_pop(void)
 {
-	POPSTK(var_solutn_stack, var_grounding);
-	POPSTK(term_solutn_stack, clause_grounding);
+	OC_ASSERT(not solutn_marks.empty(), "Unbalanced solution trail");
+	solution_undo(solutn_marks.back());
+	solutn_marks.pop_back();
 }
 
 void PatternMatchEngine::solution_drop(void)
 {
-	var_solutn_stack.pop();
-	term_solutn_stack.pop();
+	solutn_marks.pop_back();
+
+	// With no mark left, nothing will ever be undone.
+	if (solutn_marks.empty()) solutn_trail.clear();
+}
+
+/// Add a clause to the issued set, logging it for clause_stacks_pop().
+void PatternMatchEngine::issue(const Handle& clause)
+{
+	if (not issued.insert(clause).second) return;
+	if (not issued_marks.empty())
+		issued_trail.push_back(clause);
 }
 
 /* ======================================================== */
@@ -1735,6 +1992,7 @@ bool PatternMatchEngine::explore_neighborhood(const Handle& do_clause,
                                               const Handle& term,
                                               const Handle& grnd)
 {
+	if (_control) _control->check();
 	clause_stacks_clear();
 	return explore_redex(term, grnd, do_clause);
 }
@@ -1754,7 +2012,7 @@ bool PatternMatchEngine::explore_redex(const Handle& term,
 	clear_current_state();
 
 	// Match the required clauses.
-	issued.insert(first_clause);
+	issue(first_clause);
 	return explore_clause(term, grnd, first_clause);
 }
 
@@ -1805,6 +2063,8 @@ void PatternMatchEngine::clear_current_state(void)
 	// Clear all state.
 	var_grounding.clear();
 	clause_grounding.clear();
+	solutn_trail.clear();
+	issued_trail.clear();
 
 	depth = 0;
 
@@ -1824,6 +2084,8 @@ void PatternMatchEngine::clear_current_state(void)
 PatternMatchEngine::PatternMatchEngine(PatternMatchCallback& pmcb)
 	: _pmc(pmcb),
 	_classserver(classserver()),
+	_control(ExecControl::current()),
+	_steps(0),
 	_varlist(NULL),
 	_pat(NULL)
 {
@@ -32,6 +32,7 @@
 
 #include <opencog/atoms/base/ClassServer.h>
 #include <opencog/atoms/pattern/Pattern.h>
+#include <opencog/atomutils/ExecControl.h>
 #include <opencog/query/PatternMatchCallback.h>
 
 namespace opencog {
@@ -43,6 +44,11 @@ class PatternMatchEngine
 	PatternMatchCallback &_pmc;
 	ClassServer& _classserver;
 
+	// Cancellation, deadline and step budget of the search, if any.
+	// The control is polled every few steps.
+	ExecControl* _control;
+	unsigned int _steps;
+
 	// Private, locally scoped typedefs, not used outside of this class.
 
 private:
@@ -120,6 +126,18 @@ private:
 	Permutation curr_perm(const PatternTermPtr&, const Handle&, bool&);
 	bool have_perm(const PatternTermPtr&, const Handle&);
 
+	// Which of the (sorted) terms of an unordered link could be
+	// grounded at which position of the candidate's outgoing set.
+	// Only the permutations that fit are explored.
+	typedef std::vector<std::vector<bool>> PermFit;
+	PermFit perm_fit(const PatternTermSeq&, const HandleSeq&);
+	bool term_fits(const PatternTermPtr&, const Handle&, bool);
+	static bool next_fit(std::vector<size_t>&, const PermFit&, bool);
+	static bool can_complete(const PermFit&, const std::vector<bool>&,
+	                         size_t);
+	static bool augment(size_t, const PermFit&, size_t,
+	                    std::vector<size_t>&, std::vector<bool>&);
+
 	// Iteration control for unordered links. Branchpoint advances
 	// whenever take_step is set to true.
 	bool take_step;
@@ -138,8 +156,11 @@ private:
 	Handle next_clause;
 	Handle next_joint;
 	// Set of clauses for which a grounding is currently being attempted.
+	// Clauses are only ever added during a search; issue() logs them
+	// on issued_trail, so that clause_stacks_pop() can take them out.
 	typedef OrderedHandleSet IssuedSet;
-	IssuedSet issued;     // stacked on issued_stack
+	IssuedSet issued;
+	void issue(const Handle&);
 
 	// -------------------------------------------
 	// Stack used to store current traversal state for a single
@@ -151,12 +172,27 @@ private:
 	void solution_pop(void);
 	void solution_drop(void);
 
-	// Stacks containing partial groundings.
-	typedef HandleMap SolnMap;
-	std::stack<SolnMap> var_solutn_stack;
-	std::stack<SolnMap> term_solutn_stack;
+	// Partial groundings are not copied when pushed. Instead, every
+	// change to var_grounding or clause_grounding is logged on the
+	// trail, together with what it replaced, and a push just marks
+	// the current end of the trail. A pop undoes the changes made
+	// since the mark, newest first. A drop forgets the mark, keeping
+	// the changes, which the next mark down will undo.
+	struct Binding
+	{
+		HandleMap* map;
+		Handle key;
+		Handle prev;
+		bool had_prev;
+	};
+	std::vector<Binding> solutn_trail;
+	std::vector<size_t> solutn_marks;
+	void set_grounding(HandleMap&, const Handle&, const Handle&);
+	void solution_undo(size_t);
+
+	std::vector<Handle> issued_trail;
+	std::vector<size_t> issued_marks;
 
-	std::stack<IssuedSet> issued_stack;
 	std::stack<ChoiceState> choice_stack;
 
 	std::stack<PermState> perm_stack;
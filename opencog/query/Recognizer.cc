@@ -80,6 +80,7 @@ class Recognizer :
 		virtual bool node_match(const Handle&, const Handle&);
 		virtual bool link_match(const PatternTermPtr&, const Handle&);
 		virtual bool fuzzy_match(const Handle&, const Handle&);
+		virtual bool strict_match(void) { return false; }
 		virtual bool grounding(const HandleMap &var_soln,
 		                       const HandleMap &term_soln);
 };
@@ -98,25 +98,29 @@ bool SatisfyingSet::grounding(const HandleMap &var_soln,
 	if (_satisfying_set.size() >= max_results)
 		return true;
 
+	Handle gnd;
 	if (1 == _varseq.size())
 	{
-		_satisfying_set.emplace(var_soln.at(_varseq[0]));
-
-		// If we found as many as we want, then stop looking for more.
-		return (_satisfying_set.size() >= max_results);
+		gnd = var_soln.at(_varseq[0]);
 	}
-
-	// If more than one variable, encapsulate in sequential order,
-	// in a ListLink.
-	HandleSeq vargnds;
-	for (const Handle& hv : _varseq)
+	else
 	{
-		vargnds.push_back(var_soln.at(hv));
+		// If more than one variable, encapsulate in sequential order,
+		// in a ListLink.
+		HandleSeq vargnds;
+		for (const Handle& hv : _varseq)
+		{
+			vargnds.push_back(var_soln.at(hv));
+		}
+		gnd = Handle(createLink(LIST_LINK, vargnds));
 	}
-	_satisfying_set.emplace(Handle(createLink(LIST_LINK, vargnds)));
+
+	// When streaming, pass on new groundings right away.
+	if (_satisfying_set.emplace(gnd).second and on_result)
+		_stopped = on_result(gnd);
 
 	// If we found as many as we want, then stop looking for more.
-	return (_satisfying_set.size() >= max_results);
+	return _stopped or (_satisfying_set.size() >= max_results);
 }
 
 TruthValuePtr opencog::satisfaction_link(AtomSpace* as, const Handle& hlink)
@@ -173,4 +177,39 @@ Handle opencog::satisfying_set(AtomSpace* as, const Handle& hlink, size_t max_re
 	return as->add_link(SET_LINK, satvec);
 }
 
+size_t opencog::satisfying_set_stream(AtomSpace* as, const Handle& hlink,
+                                      ResultCallback cb, size_t max_results)
+{
+	Type blt = hlink->getType();
+	if (BIND_LINK == blt)
+	{
+		return bindlink_stream(as, hlink, cb, max_results);
+	}
+	if (DUAL_LINK == blt)
+	{
+		// The recognizer has no incremental mode.
+		size_t n = 0;
+		for (const Handle& h : recognize(as, hlink)->getOutgoingSet())
+		{
+			if (n >= max_results) break;
+			n++;
+			if (cb(h)) break;
+		}
+		return n;
+	}
+
+	PatternLinkPtr bl(PatternLinkCast(hlink));
+	if (NULL == bl)
+	{
+		bl = createPatternLink(*LinkCast(hlink));
+	}
+
+	SatisfyingSet sater(as);
+	sater.max_results = max_results;
+	sater.on_result = cb;
+	bl->satisfy(sater);
+
+	return sater._satisfying_set.size();
+}
+
 /* ===================== END OF FILE ===================== */
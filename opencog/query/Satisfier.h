@@ -29,6 +29,7 @@
 #include <opencog/truthvalue/TruthValue.h>
 #include <opencog/atomspace/AtomSpace.h>
 
+#include <opencog/query/BindLinkAPI.h>
 #include <opencog/query/InitiateSearchCB.h>
 #include <opencog/query/DefaultPatternMatchCB.h>
 
@@ -84,7 +85,8 @@ class Satisfier :
  *
  * This will record every grounding that is found. Thus, after running,
  * the SatisfyingSet can be examined to see all the groundings that were
- * found.
+ * found.  If `on_result` is set, each new grounding is also passed to
+ * it, as soon as it is found.
  */
 
 class SatisfyingSet :
@@ -93,10 +95,13 @@ class SatisfyingSet :
 {
 	public:
 		SatisfyingSet(AtomSpace* as) :
-			InitiateSearchCB(as), DefaultPatternMatchCB(as), max_results(SIZE_MAX) {}
+			InitiateSearchCB(as), DefaultPatternMatchCB(as),
+			max_results(SIZE_MAX), _stopped(false) {}
 		HandleSeq _varseq;
 		OrderedHandleSet _satisfying_set;
 		size_t max_results;
+		ResultCallback on_result;
+		bool _stopped;
 
 		virtual void set_pattern(const Variables& vars,
 		                         const Pattern& pat)
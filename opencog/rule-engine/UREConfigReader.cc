@@ -33,6 +33,10 @@ using namespace opencog;
 const std::string UREConfigReader::top_rbs_name = "URE";
 const std::string UREConfigReader::attention_alloc_name = "URE:attention-allocation";
 const std::string UREConfigReader::max_iter_name = "URE:maximum-iterations";
+const std::string UREConfigReader::fc_batch_size_name = "URE:FC-batch-size";
+const std::string UREConfigReader::bc_fulfill_parallelism_name = "URE:BC-fulfill-parallelism";
+const std::string UREConfigReader::fc_incremental_name = "URE:FC-incremental";
+const std::string UREConfigReader::fc_dump_trace_name = "URE:FC-dump-trace";
 
 UREConfigReader::UREConfigReader(AtomSpace& as, const Handle& rbs) : _as(as)
 {
@@ -47,8 +51,22 @@ UREConfigReader::UREConfigReader(AtomSpace& as, const Handle& rbs) : _as(as)
 	// Fetch maximum number of iterations
 	_rbparams.max_iter = fetch_num_param(max_iter_name, rbs);
 
+	// Fetch the forward chainer batch size, sequential by default
+	_rbparams.fc_batch_size = fetch_num_param(fc_batch_size_name, rbs, 1);
+
+	// Fetch the backward chainer fulfillment parallelism, sequential
+	// by default
+	_rbparams.bc_fulfill_parallelism =
+		fetch_num_param(bc_fulfill_parallelism_name, rbs, 1);
+
 	// Fetch attention allocation parameter
 	_rbparams.attention_alloc = fetch_bool_param(attention_alloc_name, rbs);
+
+	// Fetch whether the forward chainer matches rules incrementally
+	_rbparams.fc_incremental = fetch_bool_param(fc_incremental_name, rbs, false);
+
+	// Fetch whether the forward chainer trace goes to the AtomSpace
+	_rbparams.fc_dump_trace = fetch_bool_param(fc_dump_trace_name, rbs, true);
 }
 
 const RuleSet& UREConfigReader::get_rules() const
@@ -71,6 +89,26 @@ int UREConfigReader::get_maximum_iterations() const
 	return _rbparams.max_iter;
 }
 
+int UREConfigReader::get_fc_batch_size() const
+{
+	return _rbparams.fc_batch_size;
+}
+
+int UREConfigReader::get_bc_fulfill_parallelism() const
+{
+	return _rbparams.bc_fulfill_parallelism;
+}
+
+bool UREConfigReader::get_fc_incremental() const
+{
+	return _rbparams.fc_incremental;
+}
+
+bool UREConfigReader::get_fc_dump_trace() const
+{
+	return _rbparams.fc_dump_trace;
+}
+
 void UREConfigReader::set_attention_allocation(bool aa)
 {
 	_rbparams.attention_alloc = aa;
@@ -81,6 +119,26 @@ void UREConfigReader::set_maximum_iterations(int mi)
 	_rbparams.max_iter = mi;
 }
 
+void UREConfigReader::set_fc_batch_size(int bs)
+{
+	_rbparams.fc_batch_size = bs;
+}
+
+void UREConfigReader::set_bc_fulfill_parallelism(int p)
+{
+	_rbparams.bc_fulfill_parallelism = p;
+}
+
+void UREConfigReader::set_fc_incremental(bool inc)
+{
+	_rbparams.fc_incremental = inc;
+}
+
+void UREConfigReader::set_fc_dump_trace(bool dt)
+{
+	_rbparams.fc_dump_trace = dt;
+}
+
 HandleSeq UREConfigReader::fetch_rule_names(const Handle& rbs)
 {
 	// Retrieve rules
@@ -164,10 +222,13 @@ double UREConfigReader::fetch_num_param(const string& schema_name,
 }
 
 bool UREConfigReader::fetch_bool_param(const string& pred_name,
-                                       const Handle& input)
+                                       const Handle& input,
+                                       bool default_value)
 {
 	Handle pred = _as.add_node(PREDICATE_NODE, pred_name);
 	TruthValuePtr tv =
 		_as.add_link(EVALUATION_LINK, pred, input)->getTruthValue();
+	if (tv->isDefaultTV())
+		return default_value;
 	return tv->getMean() > 0.5;
 }
@@ -54,11 +54,19 @@ public:
 	RuleSet& get_rules();
 	bool get_attention_allocation() const;
 	int get_maximum_iterations() const;
+	int get_fc_batch_size() const;
+	int get_bc_fulfill_parallelism() const;
+	bool get_fc_incremental() const;
+	bool get_fc_dump_trace() const;
 
 	// Modifiers. WARNING: Those changes are not reflected in the
 	// AtomSpace, only in the UREConfigReader object.
 	void set_attention_allocation(bool);
 	void set_maximum_iterations(int);
+	void set_fc_batch_size(int);
+	void set_bc_fulfill_parallelism(int);
+	void set_fc_incremental(bool);
+	void set_fc_dump_trace(bool);
 
 	// Name of the top rule base from which all rule-based systems
 	// inherit. It should corresponds to a ConceptNode in the
@@ -72,6 +80,22 @@ public:
 	// Name of the SchemaNode outputing the maximum iterations
 	// parameter
 	static const std::string max_iter_name;
+
+	// Name of the SchemaNode outputing the number of rules that the
+	// forward chainer applies concurrently
+	static const std::string fc_batch_size_name;
+
+	// Name of the SchemaNode outputing the number of and-BITs that the
+	// backward chainer fulfills concurrently
+	static const std::string bc_fulfill_parallelism_name;
+
+	// Name of the PredicateNode outputing whether the forward chainer
+	// matches the rules incrementally when applying all of them
+	static const std::string fc_incremental_name;
+
+	// Name of the PredicateNode outputing whether the forward chainer
+	// writes its inference trace in the AtomSpace once done chaining
+	static const std::string fc_dump_trace_name;
 private:
 
 	// Fetch from the AtomSpace all rules of a given rube-based
@@ -88,6 +112,10 @@ private:
 		RuleSet rules;
 		bool attention_alloc;
 		int max_iter;
+		int fc_batch_size;
+		int bc_fulfill_parallelism;
+		bool fc_incremental;
+		bool fc_dump_trace;
 	};
 	RuleBaseParameters _rbparams;
 
@@ -133,7 +161,8 @@ private:
 	//
 	// Return TV.mean > 0.5 or default_value in case no such
 	// EvaluationLink exists.
-	bool fetch_bool_param(const std::string& pred_name, const Handle& input);
+	bool fetch_bool_param(const std::string& pred_name, const Handle& input,
+	                      bool default_value = true);
 };
 
 } // ~namespace opencog
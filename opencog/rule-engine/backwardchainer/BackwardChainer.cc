@@ -23,9 +23,15 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <sstream>
+
 #include <boost/range/algorithm/remove_if.hpp>
 
 #include <opencog/util/random.h>
+#include <opencog/util/mt19937ar.h>
 
 #include <opencog/atomutils/FindUtils.h>
 #include <opencog/atomutils/Substitutor.h>
@@ -34,6 +40,7 @@
 #include <opencog/atoms/pattern/PatternLink.h>
 #include <opencog/atoms/pattern/BindLink.h>
 
+#include <opencog/atoms/execution/EvaluationPool.h>
 #include <opencog/query/BindLinkAPI.h>
 
 #include "BackwardChainer.h"
@@ -53,7 +60,16 @@ BackwardChainer::BackwardChainer(AtomSpace& as, const Handle& rbs,
 	: _as(as), _configReader(as, rbs),
 	  _init_target(htarget), _init_vardecl(vardecl), _init_fitness(fitness),
 	  _bit_as(&as), _iteration(0), _last_expansion_andbit(nullptr),
-	  _rules(_configReader.get_rules()) {}
+	  _rules(_configReader.get_rules()), _unify_cache_rules(0),
+	  _unify_cache_hits(0), _unify_cache_misses(0) {}
+
+BackwardChainer::~BackwardChainer()
+{
+	// The fulfillments refer to this; errors were already reported,
+	// or would have been, by do_chain().
+	for (std::future<void>& f : _fulfillments)
+		f.wait();
+}
 
 UREConfigReader& BackwardChainer::get_config()
 {
@@ -71,6 +87,10 @@ void BackwardChainer::do_chain()
 	{
 		do_step();
 	}
+	wait_fulfillments();
+
+	bc_logger().debug("Unification cache: %zu hits, %zu misses",
+	                  _unify_cache_hits, _unify_cache_misses);
 }
 
 void BackwardChainer::do_step()
@@ -145,8 +165,8 @@ void BackwardChainer::expand_bit(const AndBITFCMap::value_type& andbit,
 {
 	// Make sure that the rule is not already an or-child of bitleaf.
 	if (is_in(rule, bitleaf)) {
-		bc_logger().debug() << "An equivalent rule has already expanded "
-		                    << "that BIT-node, abort expansion";
+		LAZY_BC_LOG_DEBUG << "An equivalent rule has already expanded "
+		                  << "that BIT-node, abort expansion";
 		return;
 	}
 
@@ -348,7 +368,14 @@ void BackwardChainer::fulfill_bit()
 	const AndBITFCMap::value_type& andbit = select_andbit();
 	LAZY_BC_LOG_DEBUG << "Selected and-BIT for fulfillment:" << std::endl
 	                  << andbit.second;
-	fulfill_andbit(andbit);
+
+	int parallelism = _configReader.get_bc_fulfill_parallelism();
+	if (1 < parallelism) {
+		fulfill_andbit_async(andbit, parallelism);
+	} else {
+		wait_fulfillments();
+		fulfill_andbit(andbit);
+	}
 }
 
 void BackwardChainer::fulfill_andbit(const AndBITFCMap::value_type& andbit)
@@ -356,9 +383,70 @@ void BackwardChainer::fulfill_andbit(const AndBITFCMap::value_type& andbit)
 	Handle hresult = bindlink(&_as, andbit.second);
 	const HandleSeq& results = hresult->getOutgoingSet();
 	LAZY_BC_LOG_DEBUG << "Results:" << std::endl << results;
+	std::lock_guard<std::mutex> lock(_results_mtx);
 	_results.insert(results.begin(), results.end());
 }
 
+void BackwardChainer::fulfill_fcs(const Handle& fcs)
+{
+	// Ground in a scratch space of our own, so that the pattern
+	// matcher never sees the atoms another fulfillment is creating.
+	AtomSpace* scratch = AtomSpace::grab_transient(&_as);
+	HandleSeq results;
+	try {
+		Handle hresult = bindlink(scratch, fcs);
+		for (const Handle& h : hresult->getOutgoingSet())
+			results.push_back(_as.add_atom(h));
+	} catch (...) {
+		AtomSpace::release_transient(scratch);
+		throw;
+	}
+	AtomSpace::release_transient(scratch);
+
+	LAZY_BC_LOG_DEBUG << "Results:" << std::endl << results;
+	std::lock_guard<std::mutex> lock(_results_mtx);
+	_results.insert(results.begin(), results.end());
+}
+
+/**
+ * Fulfill the and-BIT on the EvaluationPool, and return right away,
+ * so that the next expansion overlaps with it.  Rule formulas written
+ * in scheme still run one at a time, unless SchemeEval::enable_threads()
+ * has been called.
+ */
+void BackwardChainer::fulfill_andbit_async(const AndBITFCMap::value_type& andbit,
+                                           size_t max_pending)
+{
+	wait_fulfillments(max_pending - 1);
+
+	Handle fcs = andbit.second;
+	auto done = std::make_shared<std::promise<void>>();
+	_fulfillments.push_back(done->get_future());
+	EvaluationPool::instance().submit([this, fcs, done]() {
+		try {
+			fulfill_fcs(fcs);
+			done->set_value();
+		} catch (...) {
+			done->set_exception(std::current_exception());
+		}
+	});
+}
+
+void BackwardChainer::wait_fulfillments()
+{
+	wait_fulfillments(0);
+}
+
+void BackwardChainer::wait_fulfillments(size_t max_pending)
+{
+	while (max_pending < _fulfillments.size()) {
+		std::future<void> f = std::move(_fulfillments.front());
+		_fulfillments.pop_front();
+		// Rethrows whatever the fulfillment threw
+		f.get();
+	}
+}
+
 const AndBITFCMap::value_type& BackwardChainer::select_andbit()
 {
 	// Select the lastly expanded and-BIT, or a uniformly random one
@@ -389,13 +477,116 @@ Rule BackwardChainer::select_rule(const BITNode& target)
 	return rand_element(valid_rules);
 }
 
+/**
+ * Rename the declared variables of a target to $__bc-var-0,
+ * $__bc-var-1, ... in the order in which they first occur in its body,
+ * and sort its declarations accordingly.  Alpha-equivalent targets
+ * thus become equal.  Fills canon with the renaming, from the new
+ * variables back to the original ones.
+ */
+static void canonize_target(const Handle& body, const Handle& vardecl,
+                            Handle& cbody, Handle& cvardecl,
+                            HandleMap& canon)
+{
+	// An undefined vardecl declares the free variables of the body,
+	// as in unify().
+	VariableListPtr vl = gen_varlist(body, vardecl);
+	const Variables& vars = vl->get_variables();
+
+	// Declared variables, in order of first occurrence, then the
+	// unused ones.
+	HandleSeq order;
+	std::function<void(const Handle&)> walk = [&](const Handle& h) {
+		if (vars.is_in_varset(h)) {
+			if (std::find(order.begin(), order.end(), h) == order.end())
+				order.push_back(h);
+		} else if (h->isLink()) {
+			for (const Handle& child : h->getOutgoingSet())
+				walk(child);
+		}
+	};
+	walk(body);
+	for (const Handle& var : vars.varseq)
+		if (std::find(order.begin(), order.end(), var) == order.end())
+			order.push_back(var);
+
+	HandleMap rename;
+	for (size_t i = 0; i < order.size(); i++) {
+		Handle cvar(createNode(VARIABLE_NODE,
+		                       "$__bc-var-" + std::to_string(i)));
+		rename[order[i]] = cvar;
+		canon[cvar] = order[i];
+	}
+
+	HandleSeq decls = vl->getOutgoingSet();
+	for (Handle& decl : decls)
+		decl = Substitutor::substitute(decl, rename);
+
+	auto decl_var = [](const Handle& decl) {
+		return decl->isLink() ? decl->getOutgoingAtom(0) : decl;
+	};
+	std::sort(decls.begin(), decls.end(),
+	          [&](const Handle& l, const Handle& r) {
+		          return decl_var(l)->getName() < decl_var(r)->getName();
+	          });
+
+	cbody = Substitutor::substitute(body, rename);
+	cvardecl = Handle(createVariableList(decls));
+}
+
+/**
+ * Copy a rule unified with a canonical target, renaming the canonical
+ * variables back to the target's, and giving the rule's own variables
+ * fresh names.
+ */
+static Rule uncanonize_rule(const Rule& rule, const HandleMap& canon)
+{
+	Handle fwd = rule.get_forward_rule();
+
+	HandleMap rename(canon);
+	for (const Handle& var : BindLinkCast(fwd)->get_variables().varseq) {
+		if (rename.find(var) != rename.end())
+			continue;
+		std::stringstream ss;
+		ss << var->getName() << "-" << std::hex << randGen().randint();
+		rename[var] = Handle(createNode(VARIABLE_NODE, ss.str()));
+	}
+
+	Handle h = Substitutor::substitute(fwd, rename);
+	Rule result(rule);
+	result.set_forward_handle(Handle(createBindLink(h->getOutgoingSet())));
+	return result;
+}
+
 RuleSet BackwardChainer::get_valid_rules(const BITNode& target)
 {
-	RuleSet valid_rules;
-	for (const Rule& rule : _rules) {
-		RuleSet unified_rules = rule.unify_target(target.body, target.vardecl);
-		valid_rules.insert(unified_rules.begin(), unified_rules.end());
+	if (_unify_cache_rules != _rules.size()) {
+		_unify_cache.clear();
+		_unify_cache_rules = _rules.size();
 	}
+
+	Handle cbody, cvardecl;
+	HandleMap canon;
+	canonize_target(target.body, target.vardecl, cbody, cvardecl, canon);
+
+	Handle key(createLink(LIST_LINK, cvardecl, cbody));
+
+	auto it = _unify_cache.find(key);
+	if (it == _unify_cache.end()) {
+		_unify_cache_misses++;
+		RuleSet unified;
+		for (const Rule& rule : _rules) {
+			RuleSet unified_rules = rule.unify_target(cbody, cvardecl);
+			unified.insert(unified_rules.begin(), unified_rules.end());
+		}
+		it = _unify_cache.emplace(key, unified).first;
+	} else {
+		_unify_cache_hits++;
+	}
+
+	RuleSet valid_rules;
+	for (const Rule& rule : it->second)
+		valid_rules.insert(uncanonize_rule(rule, canon));
 	return valid_rules;
 }
 
@@ -482,9 +673,9 @@ void BackwardChainer::associate_andbit_leaves_to_fcs(const OrderedHandleSet& lea
 		_last_expansion_andbit = &*it_success.first;
 	}
 	else {
-		bc_logger().warn() << "The and-BIT with the following leaves:"
-		                   << std::endl << oc_to_string(leaves) << std::endl
-		                   << "and the following FCS:" << std::endl
-		                   << fcs << "is already in the BIT.";
+		LAZY_BC_LOG_WARN << "The and-BIT with the following leaves:"
+		                 << std::endl << oc_to_string(leaves) << std::endl
+		                 << "and the following FCS:" << std::endl
+		                 << fcs << "is already in the BIT.";
 	}
 }
@@ -25,6 +25,11 @@
 #ifndef BACKWARDCHAINER_H_
 #define BACKWARDCHAINER_H_
 
+#include <deque>
+#include <future>
+#include <mutex>
+#include <unordered_map>
+
 #include <opencog/rule-engine/Rule.h>
 #include <opencog/rule-engine/UREConfigReader.h>
 
@@ -97,6 +102,7 @@ public:
 	                const Handle& vardecl = Handle::UNDEFINED,
 	                const Handle& hfocus_set = Handle::UNDEFINED,
 	                const BITFitness& fitness = BITFitness());
+	~BackwardChainer();
 
 	/**
 	 * URE configuration accessors
@@ -120,12 +126,27 @@ public:
 	 */
 	bool termination();
 
+	/**
+	 * Wait for the and-BIT fulfillments still running, if
+	 * URE:BC-fulfill-parallelism is above 1.  do_chain() does this
+	 * before returning; callers of do_step() must do it before
+	 * get_results().
+	 */
+	void wait_fulfillments();
+
 	/**
 	 * Get the current result on the initial target, a SetLink with
 	 * all inferred atoms matching the target.
 	 */
 	Handle get_results() const;
 
+	/**
+	 * Number of get_valid_rules() calls answered from, and added to,
+	 * the unification cache.
+	 */
+	size_t get_unify_cache_hits() const { return _unify_cache_hits; }
+	size_t get_unify_cache_misses() const { return _unify_cache_misses; }
+
 private:
 	// Expand the BIT
 	void expand_bit();
@@ -178,6 +199,20 @@ private:
 	// strategy.
 	void fulfill_andbit(const AndBITFCMap::value_type& andbit);
 
+	// Fulfill the forward chaining strategy of an and-BIT in a
+	// transient atomspace, copy the results to _as, and add them to
+	// _results.  May run concurrently with the expansion, and with
+	// other fulfillments.
+	void fulfill_fcs(const Handle& fcs);
+
+	// Start fulfilling the and-BIT on the EvaluationPool, once fewer
+	// than max_pending fulfillments are running.
+	void fulfill_andbit_async(const AndBITFCMap::value_type& andbit,
+	                          size_t max_pending);
+
+	// Wait until at most max_pending fulfillments are running.
+	void wait_fulfillments(size_t max_pending);
+
 	// Reduce the BIT. Remove some and-BITs.
 	void reduce_bit();
 
@@ -195,6 +230,13 @@ private:
 
 	// Return all valid rules, in the sense that these rules may
 	// possibly be used to infer the target.
+	//
+	// Unifying every rule with the target is expensive, and the BIT
+	// keeps coming back to alpha-equivalent targets, so the unified
+	// rules are cached, keyed by the target with its variables
+	// renamed in a canonical way.  Each call returns copies of the
+	// cached rules, with fresh variable names, as rule unification
+	// does.
 	RuleSet get_valid_rules(const BITNode& target);
 
 	// Add body and vardecl into _bit_as, build the bitnode associated
@@ -265,7 +307,19 @@ private:
 
 	RuleSet _rules;
 
+	// Rules unified with canonical targets, for get_valid_rules().
+	// It is cleared whenever the rule set changes size, as meta rules
+	// get expanded.
+	std::unordered_map<Handle, RuleSet> _unify_cache;
+	size_t _unify_cache_rules;
+	size_t _unify_cache_hits;
+	size_t _unify_cache_misses;
+
 	OrderedHandleSet _results;
+	std::mutex _results_mtx;
+
+	// Fulfillments running on the EvaluationPool, oldest first
+	std::deque<std::future<void>> _fulfillments;
 };
 
 
@@ -36,6 +36,7 @@ public:
 	virtual ~UnifyPMCB();
 
 	virtual bool node_match(const Handle&, const Handle&);
+	virtual bool strict_match(void) { return false; }
 	virtual bool variable_match(const Handle&, const Handle&);
 	virtual bool grounding(const HandleMap &var_soln,
 	                       const HandleMap &pred_soln);
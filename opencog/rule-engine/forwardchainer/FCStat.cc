@@ -21,29 +21,77 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <opencog/util/Logger.h>
+
 #include "../ChainerUtils.h"
 #include "FCStat.h"
 
 using namespace opencog;
 
+FCStat::FCStat(AtomSpace& as, size_t trace_capacity)
+	: _capacity(trace_capacity), _head(0), _dropped(0), _as(as) {}
+
 void FCStat::add_inference_record(unsigned iteration, Handle source,
                                   const Rule& rule,
                                   const UnorderedHandleSet& product)
 {
-	_inf_rec.emplace_back(source, rule, product);
+	_products.insert(product.begin(), product.end());
 
-	for (const Handle& p : product)
-		_as.add_link(EXECUTION_LINK,
-		             rule.get_alias(),
-		             _as.add_node(NUMBER_NODE, std::to_string(iteration)),
-		             source, p);
+	if (0 == _capacity) {
+		_dropped += product.size();
+		return;
+	}
+
+	for (const Handle& p : product) {
+		InferenceRecord rec{iteration, &rule, source, p};
+		if (_trace.size() < _capacity) {
+			_trace.push_back(rec);
+		} else {
+			_trace[_head] = rec;
+			_head = (_head + 1) % _capacity;
+			_dropped++;
+		}
+	}
 }
 
 UnorderedHandleSet FCStat::get_all_products()
 {
-	UnorderedHandleSet all;
-	for(const auto& ir : _inf_rec)
-		all.insert(ir.product.begin(),ir.product.end());
+	return _products;
+}
+
+std::vector<InferenceRecord> FCStat::get_trace() const
+{
+	std::vector<InferenceRecord> trace(_trace.begin() + _head, _trace.end());
+	trace.insert(trace.end(), _trace.begin(), _trace.begin() + _head);
+	return trace;
+}
+
+void FCStat::dump_trace()
+{
+	if (0 < _dropped)
+		logger().warn("[FCStat] Incomplete inference trace: %zu records "
+		              "dropped so far, past the capacity of %zu; see "
+		              "set_trace_capacity()", _dropped, _capacity);
 
-	return all;
+	for (const InferenceRecord& rec : get_trace()) {
+		if (Handle::UNDEFINED == rec.product) continue;
+		_as.add_link(EXECUTION_LINK,
+		             rec.rule->get_alias(),
+		             _as.add_node(NUMBER_NODE, std::to_string(rec.iteration)),
+		             rec.source, rec.product);
+	}
+	_trace.clear();
+	_head = 0;
+}
+
+void FCStat::set_trace_capacity(size_t capacity)
+{
+	std::vector<InferenceRecord> trace = get_trace();
+	if (capacity < trace.size()) {
+		_dropped += trace.size() - capacity;
+		trace.erase(trace.begin(), trace.end() - capacity);
+	}
+	_trace.swap(trace);
+	_capacity = capacity;
+	_head = 0;
 }
@@ -25,34 +25,57 @@
 #define _FCSTAT_H_
 
 #include <opencog/atoms/base/Handle.h>
-#include <map>
+#include <vector>
 
 #include "../Rule.h"
 
 namespace opencog {
 
+/**
+ * One product of an inference step.  All records have the same small
+ * size, so that the trace fits in a single array.
+ */
 struct InferenceRecord
 {
-	const Handle hsource;
-	const Rule& rule;
-	UnorderedHandleSet product;
-
-	InferenceRecord(Handle h, const Rule& r, const UnorderedHandleSet& p)
-		: hsource(h), rule(r), product(p) {}
+	unsigned iteration;
+	const Rule* rule;
+	Handle source;
+	Handle product;
 };
 
 class FCStat
 {
 private:
-	std::vector<InferenceRecord> _inf_rec;
+	// The trace, a ring of at most _capacity records; once full, the
+	// oldest record is at _head, and is overwritten next.
+	std::vector<InferenceRecord> _trace;
+	size_t _capacity;
+	size_t _head;
+	size_t _dropped;
+
+	UnorderedHandleSet _products;
 	AtomSpace& _as;
 
 public:
-	FCStat(AtomSpace& as) : _as(as) {}
+	static const size_t default_trace_capacity = 1 << 16;
+
+	FCStat(AtomSpace& as, size_t trace_capacity = default_trace_capacity);
+
+	/**
+	 * Record the inference step into memory.  Nothing is written to
+	 * the atomspace until dump_trace() is called; if the trace is
+	 * full, the oldest records are dropped, but all products are
+	 * still returned by get_all_products().
+	 */
+	void add_inference_record(unsigned iteration, Handle source,
+	                          const Rule& rule,
+	                          const UnorderedHandleSet& product);
+	UnorderedHandleSet get_all_products();
 
 	/**
-	 * Record the inference step into memory, as well as in the
-	 * atomspace according to the following format:
+	 * Write the recorded trace in the atomspace, oldest first, then
+	 * clear it.  A warning is logged if records have been dropped.
+	 * Each record is written as
 	 *
 	 * ExecutionLink
 	 *    <rule>
@@ -63,14 +86,20 @@ public:
 	 * where
 	 *
 	 * 1. <rule> is DefinedSchemaNode <rule-name>
-	 * 2. <rule> is NumberNode <#iteration>
+	 * 2. <step> is NumberNode <#iteration>
 	 * 3. <source> is the source
-	 * 4. <product> is a SetLink <p1> ... <pn> where pi are the products
+	 * 4. <product> is the product
 	 */
-	void add_inference_record(unsigned iteration, Handle source,
-	                          const Rule& rule,
-	                          const UnorderedHandleSet& product);
-	UnorderedHandleSet get_all_products();
+	void dump_trace();
+
+	/// The recorded trace, oldest first.
+	std::vector<InferenceRecord> get_trace() const;
+
+	/// Number of records dropped because the trace was full.
+	size_t get_dropped() const { return _dropped; }
+
+	/// Change the maximum number of records, keeping the newest.
+	void set_trace_capacity(size_t capacity);
 };
 
 }
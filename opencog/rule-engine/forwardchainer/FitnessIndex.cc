@@ -0,0 +1,247 @@
+/*
+ * FitnessIndex.cc
+ *
+ * Copyright (C) 2016 OpenCog Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include <opencog/util/mt19937ar.h>
+
+#include "FitnessIndex.h"
+
+using namespace opencog;
+
+FitnessIndex::FitnessIndex() : _root(nullptr), _seq(0), _prio_state(2463534242U)
+{
+}
+
+FitnessIndex::~FitnessIndex()
+{
+    destroy(_root);
+}
+
+void FitnessIndex::destroy(Node* n)
+{
+    if (nullptr == n) return;
+    destroy(n->left);
+    destroy(n->right);
+    delete n;
+}
+
+bool FitnessIndex::less(const Node* a, const Node* b)
+{
+    if (a->fitness != b->fitness) return a->fitness < b->fitness;
+    return a->seq < b->seq;
+}
+
+void FitnessIndex::resize(Node* n)
+{
+    n->size = 1 + size_of(n->left) + size_of(n->right);
+}
+
+FitnessIndex::Node* FitnessIndex::merge(Node* a, Node* b)
+{
+    if (nullptr == a) return b;
+    if (nullptr == b) return a;
+
+    if (a->prio > b->prio) {
+        a->right = merge(a->right, b);
+        resize(a);
+        return a;
+    }
+    b->left = merge(a, b->left);
+    resize(b);
+    return b;
+}
+
+// Split t into the nodes ordered before key, and the others.
+void FitnessIndex::split(Node* t, const Node* key, Node*& lo, Node*& hi)
+{
+    if (nullptr == t) {
+        lo = hi = nullptr;
+        return;
+    }
+
+    if (less(t, key)) {
+        split(t->right, key, t->right, hi);
+        lo = t;
+    } else {
+        split(t->left, key, lo, t->left);
+        hi = t;
+    }
+    resize(t);
+}
+
+FitnessIndex::Node* FitnessIndex::remove(Node* t, const Node* n)
+{
+    if (t == n) return merge(t->left, t->right);
+
+    if (less(n, t))
+        t->left = remove(t->left, n);
+    else
+        t->right = remove(t->right, n);
+    resize(t);
+    return t;
+}
+
+void FitnessIndex::link(Node* n)
+{
+    n->left = n->right = nullptr;
+    n->size = 1;
+
+    Node *lo, *hi;
+    split(_root, n, lo, hi);
+    _root = merge(merge(lo, n), hi);
+}
+
+void FitnessIndex::unlink(Node* n)
+{
+    _root = remove(_root, n);
+}
+
+// ==========================================================
+
+bool FitnessIndex::insert(const Handle& h, float fitness)
+{
+    std::lock_guard<std::mutex> lck(_mtx);
+    if (_nodes.find(h) != _nodes.end()) return false;
+
+    // xorshift; the priorities only need to look random.
+    _prio_state ^= _prio_state << 13;
+    _prio_state ^= _prio_state >> 17;
+    _prio_state ^= _prio_state << 5;
+
+    Node* n = new Node{fitness, _seq++, _prio_state, 1, h, nullptr, nullptr};
+    _nodes[h] = n;
+    link(n);
+    return true;
+}
+
+bool FitnessIndex::erase(const Handle& h)
+{
+    std::lock_guard<std::mutex> lck(_mtx);
+    auto it = _nodes.find(h);
+    if (it == _nodes.end()) return false;
+
+    unlink(it->second);
+    delete it->second;
+    _nodes.erase(it);
+    return true;
+}
+
+void FitnessIndex::update(const Handle& h, float fitness)
+{
+    std::lock_guard<std::mutex> lck(_mtx);
+    auto it = _nodes.find(h);
+    if (it == _nodes.end()) return;
+
+    Node* n = it->second;
+    if (n->fitness == fitness) return;
+
+    unlink(n);
+    n->fitness = fitness;
+    link(n);
+}
+
+bool FitnessIndex::contains(const Handle& h) const
+{
+    std::lock_guard<std::mutex> lck(_mtx);
+    return _nodes.find(h) != _nodes.end();
+}
+
+float FitnessIndex::fitness(const Handle& h) const
+{
+    std::lock_guard<std::mutex> lck(_mtx);
+    auto it = _nodes.find(h);
+    if (it == _nodes.end()) return NAN;
+    return it->second->fitness;
+}
+
+size_t FitnessIndex::size() const
+{
+    std::lock_guard<std::mutex> lck(_mtx);
+    return size_of(_root);
+}
+
+void FitnessIndex::clear()
+{
+    std::lock_guard<std::mutex> lck(_mtx);
+    destroy(_root);
+    _root = nullptr;
+    _nodes.clear();
+}
+
+// ==========================================================
+
+size_t FitnessIndex::count_below(float fitness, bool or_equal) const
+{
+    size_t count = 0;
+    const Node* t = _root;
+    while (t) {
+        if (t->fitness < fitness or (or_equal and t->fitness == fitness)) {
+            count += size_of(t->left) + 1;
+            t = t->right;
+        } else {
+            t = t->left;
+        }
+    }
+    return count;
+}
+
+const FitnessIndex::Node* FitnessIndex::nth(size_t i) const
+{
+    const Node* t = _root;
+    while (t) {
+        size_t left = size_of(t->left);
+        if (i < left) {
+            t = t->left;
+        } else if (i == left) {
+            return t;
+        } else {
+            i -= left + 1;
+            t = t->right;
+        }
+    }
+    return nullptr;
+}
+
+Handle FitnessIndex::tournament_select() const
+{
+    std::lock_guard<std::mutex> lck(_mtx);
+    size_t n = size_of(_root);
+    if (0 == n) return Handle::UNDEFINED;
+
+    // The fittest of k atoms drawn with replacement has rank below j
+    // (counting from the least fit) with probability (j/n)^k.
+    size_t k = std::max(static_cast<size_t>(1), n / 2);
+    double u = randGen().randdouble();
+    size_t rank = std::min(n - 1,
+        static_cast<size_t>(n * std::pow(u, 1.0 / k)));
+    const Node* winner = nth(rank);
+
+    // Among equally fit atoms, the tournament picks any one with the
+    // same probability.
+    size_t lo = count_below(winner->fitness, false);
+    size_t hi = count_below(winner->fitness, true);
+    if (1 < hi - lo)
+        winner = nth(lo + randGen().randint(hi - lo));
+
+    return winner->h;
+}
@@ -0,0 +1,113 @@
+/*
+ * FitnessIndex.h
+ *
+ * Copyright (C) 2016 OpenCog Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_FITNESS_INDEX_H
+#define _OPENCOG_FITNESS_INDEX_H
+
+#include <mutex>
+#include <unordered_map>
+
+#include <opencog/atoms/base/Handle.h>
+
+namespace opencog
+{
+
+/**
+ * A set of atoms, each with a fitness, kept ordered by fitness, so
+ * that the forward chainer can select sources in logarithmic time.
+ *
+ * tournament_select() draws from the same distribution as
+ * URECommons::tournament_select() does, over a map of the same
+ * atoms and fitnesses: the fittest of size()/2 atoms picked at random.
+ * The winner's rank has a closed-form distribution, so it is drawn
+ * directly, and then found in the tree, instead of building the map
+ * and running the tournament.  When all fitnesses are equal, this is
+ * a uniform draw.
+ *
+ * The fitnesses are kept up to date by the owner, typically from the
+ * TV or AV change signals; all methods may be called concurrently.
+ */
+class FitnessIndex
+{
+public:
+    FitnessIndex();
+    ~FitnessIndex();
+    FitnessIndex(const FitnessIndex&) = delete;
+    FitnessIndex& operator=(const FitnessIndex&) = delete;
+
+    /// Add an atom; return false if it was already there.
+    bool insert(const Handle& h, float fitness);
+
+    /// Remove an atom; return false if it was not there.
+    bool erase(const Handle& h);
+
+    /// Change the fitness of an atom, if it is there.
+    void update(const Handle& h, float fitness);
+
+    bool contains(const Handle& h) const;
+
+    /// The fitness of an atom; NaN if it is not there.
+    float fitness(const Handle& h) const;
+
+    size_t size() const;
+    bool empty() const { return 0 == size(); }
+    void clear();
+
+    /// Run a tournament; Handle::UNDEFINED if empty.
+    Handle tournament_select() const;
+
+private:
+    // A treap, ordered by (fitness, seq), where seq is the insertion
+    // order, to break ties deterministically.
+    struct Node
+    {
+        float fitness;
+        size_t seq;
+        unsigned prio;
+        size_t size;
+        Handle h;
+        Node* left;
+        Node* right;
+    };
+
+    Node* _root;
+    size_t _seq;
+    unsigned _prio_state;
+    std::unordered_map<Handle, Node*> _nodes;
+    mutable std::mutex _mtx;
+
+    static size_t size_of(const Node* n) { return n ? n->size : 0; }
+    static bool less(const Node* a, const Node* b);
+    static void resize(Node* n);
+    static Node* merge(Node* a, Node* b);
+    static void split(Node* t, const Node* key, Node*& lo, Node*& hi);
+    static Node* remove(Node* t, const Node* n);
+    static void destroy(Node* n);
+
+    void link(Node* n);
+    void unlink(Node* n);
+    size_t count_below(float fitness, bool or_equal) const;
+    const Node* nth(size_t i) const;
+};
+
+} // ~namespace opencog
+
+#endif // _OPENCOG_FITNESS_INDEX_H
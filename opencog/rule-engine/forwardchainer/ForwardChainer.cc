@@ -21,10 +21,13 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <memory>
+
 #include <boost/range/algorithm/find.hpp>
 #include <boost/range/algorithm/sort.hpp>
 #include <boost/range/algorithm/unique_copy.hpp>
 
+#include <opencog/atoms/execution/EvaluationPool.h>
 #include <opencog/atoms/execution/Instantiator.h>
 #include <opencog/atoms/pattern/BindLink.h>
 #include <opencog/atoms/pattern/PatternLink.h>
@@ -53,6 +56,11 @@ ForwardChainer::ForwardChainer(AtomSpace& as, const Handle& rbs,
 
 ForwardChainer::~ForwardChainer()
 {
+    // It refers to the rules, and follows the atomspaces.
+    _rete.reset();
+
+    for (boost::signals2::connection& c : _fitness_connections)
+        c.disconnect();
 }
 
 void ForwardChainer::init(const Handle& hsource, const HandleSeq& focus_set)
@@ -61,6 +69,23 @@ void ForwardChainer::init(const Handle& hsource, const HandleSeq& focus_set)
 
     _search_in_af = _configReader.get_attention_allocation();
     _search_focus_set = not focus_set.empty();
+    _dump_trace = _configReader.get_fc_dump_trace();
+
+    // Keep the source fitnesses up to date.
+    auto tv_changed = [this](const Handle& h, const TruthValuePtr&,
+                             const TruthValuePtr&) {
+        update_source_fitness(h);
+    };
+    auto av_changed = [this](const Handle& h, const AttentionValuePtr&,
+                             const AttentionValuePtr&) {
+        update_source_fitness(h);
+    };
+    for (AtomSpace* as : {&_as, &_focus_set_as}) {
+        if (source_selection_mode::TV_FITNESS == _ts_mode)
+            _fitness_connections.push_back(as->TVChangedSignal(tv_changed));
+        else if (source_selection_mode::STI == _ts_mode)
+            _fitness_connections.push_back(as->AVChangedSignal(av_changed));
+    }
 
     // Set potential source.
     HandleSeq init_sources;
@@ -87,9 +112,29 @@ void ForwardChainer::init(const Handle& hsource, const HandleSeq& focus_set)
     // Set rules.
     _rules = _configReader.get_rules();
 
+    // Index the rule premises, so that select_rule() need only try
+    // the rules that the source might match.
+    _premise_index.clear();
+    for (const Rule& rule : _rules)
+        for (const Handle& premise : rule.get_premises())
+            if (is_valid_implicant(premise))
+                _premise_index.insert(&rule, premise,
+                    gen_sub_varlist(premise, rule.get_forward_vardecl()));
+
+    // Match the rules incrementally, over the atomspace that the
+    // pattern matcher would search.
+    _rete.reset();
+    if (_configReader.get_fc_incremental())
+        _rete.reset(new ReteNetwork(_search_focus_set ? _focus_set_as : _as,
+                                    _rules));
+
     // Reset the iteration count and max count
     _iteration = 0;
     _max_iteration = _configReader.get_maximum_iterations();
+
+    // Number of rules applied concurrently
+    int batch_size = _configReader.get_fc_batch_size();
+    _batch_size = 1 < batch_size ? batch_size : 1;
 }
 
 /**
@@ -130,17 +175,93 @@ void ForwardChainer::do_chain()
     if(_potential_sources.empty())
     {
         apply_all_rules();
+        if (_dump_trace)
+            dump_trace();
         return;
     }
 
     while (not termination())
     {
-        do_step();
+        if (1 < _batch_size)
+            do_batch_step();
+        else
+            do_step();
     }
 
+    // The trace is only written now, so as not to add atoms, which
+    // the rules might match, while chaining.
+    if (_dump_trace)
+        dump_trace();
+
     fc_logger().debug("Finished forwarch chaining");
 }
 
+void ForwardChainer::dump_trace()
+{
+    _fcstat.dump_trace();
+}
+
+/**
+ * Do up to _batch_size steps of forward chaining at once.
+ *
+ * The (source, rule) pairs are selected one after the other, exactly
+ * as do_step() would.  The rules are then applied concurrently, each
+ * in its own child atomspace, so that no two of them write to the
+ * same atomspace.  Finally, the products are moved to the chaining
+ * atomspace, and recorded, in the order that the pairs were selected.
+ * Rule formulas written in scheme still run one at a time, unless
+ * SchemeEval::enable_threads() has been called.
+ */
+void ForwardChainer::do_batch_step()
+{
+    struct Step
+    {
+        int iteration;
+        Handle source;
+        const Rule* rule;
+        HandleSeq products;
+    };
+
+    std::vector<Step> steps;
+    for (size_t i = 0; i < _batch_size and not termination(); i++) {
+        fc_logger().debug("Iteration %d", _iteration);
+        int iteration = _iteration++;
+
+        Handle source = select_source();
+        LAZY_FC_LOG_DEBUG << "Source:" << std::endl << source->toString();
+
+        const Rule* rule = select_rule(source);
+        if (not rule) {
+            fc_logger().debug("No selected rule, skip step");
+            continue;
+        }
+        steps.push_back({iteration, source, rule, HandleSeq()});
+    }
+
+    fc_logger().debug("Apply %zu rules concurrently", steps.size());
+
+    std::vector<std::unique_ptr<AtomSpace>> scratch;
+    std::vector<EvaluationPool::Task> tasks;
+    for (Step& step : steps) {
+        scratch.emplace_back(new AtomSpace(&_as));
+        AtomSpace* as = scratch.back().get();
+        tasks.push_back([this, as, &step]() {
+            step.products = ground_rule(*as, step.source, *step.rule);
+        });
+    }
+    EvaluationPool::instance().run_all(tasks);
+
+    for (Step& step : steps) {
+        add_results(step.products, true);
+        UnorderedHandleSet products(step.products.begin(),
+                                    step.products.end());
+        update_potential_sources(products);
+        _fcstat.add_inference_record(step.iteration, step.source,
+                                     *step.rule, products);
+    }
+    _cur_source = steps.empty() ? Handle::UNDEFINED : steps.back().source;
+}
+
 bool ForwardChainer::termination()
 {
     return _max_iteration <= _iteration;
@@ -153,6 +274,11 @@ bool ForwardChainer::termination()
  */
 void ForwardChainer::apply_all_rules()
 {
+    if (_rete) {
+        apply_all_rules_incremental();
+        return;
+    }
+
     for (const Rule& rule : _rules) {
         fc_logger().debug("Apply rule %s", rule.get_name().c_str());
         HandleSeq hs = apply_rule(rule.get_forward_rule());
@@ -166,6 +292,43 @@ void ForwardChainer::apply_all_rules()
     }
 }
 
+/**
+ * Applies all rules in the rule base, like apply_all_rules(), to the
+ * groundings completed since the last call only.  The first call thus
+ * applies the rules to everything in the atomspace; the next ones, to
+ * what was added since, including the products of the previous calls.
+ * The rules that the network cannot match are applied in full, with
+ * the pattern matcher.
+ */
+void ForwardChainer::apply_all_rules_incremental()
+{
+    std::map<const Rule*, HandleSeq> products;
+    for (const ReteNetwork::Match& match : _rete->take_matches()) {
+        Instantiator inst(&_as);
+        Handle h = inst.instantiate(match.rule->get_forward_implicand(),
+                                    match.groundings);
+        if (Handle::UNDEFINED != h)
+            products[match.rule].push_back(h);
+    }
+
+    for (const Rule& rule : _rules) {
+        fc_logger().debug("Apply rule %s", rule.get_name().c_str());
+        HandleSeq hs;
+        if (_rete->is_compiled(rule)) {
+            hs = products[&rule];
+            add_results(hs);
+        } else {
+            hs = apply_rule(rule.get_forward_rule());
+        }
+
+        _fcstat.add_inference_record(_iteration,
+                                     _as.add_node(CONCEPT_NODE, "dummy-source"),
+                                     rule,
+                                     UnorderedHandleSet(hs.begin(), hs.end()));
+        update_potential_sources(hs);
+    }
+}
+
 UnorderedHandleSet ForwardChainer::get_chaining_result()
 {
     return _fcstat.get_all_products();
@@ -177,8 +340,8 @@ Handle ForwardChainer::select_source()
 	// If all sources have been selected then insert the sources'
 	// children in the set of potential sources
 	if (_unselected_sources.empty()) {
-		fc_logger().debug() << "All " << selsrc_size
-		                    << " sources have already been selected";
+		LAZY_FC_LOG_DEBUG << "All " << selsrc_size
+		                  << " sources have already been selected";
 
 		// Hack to help to exhaust sources with
 		// multiple matching rules. This would be
@@ -198,60 +361,73 @@ Handle ForwardChainer::select_source()
 					update_potential_sources(no_free_vars_outgoings);
 				}
 			}
-			fc_logger().debug() << (_potential_sources.size() - selsrc_size)
-			                    << " sources' children have been added as "
-			                    << "potential sources";
+			LAZY_FC_LOG_DEBUG << (_potential_sources.size() - selsrc_size)
+			                  << " sources' children have been added as "
+			                  << "potential sources";
 		} else {
-			fc_logger().debug() << "No added sources, "
-			                    << "retry existing sources instead";
+			LAZY_FC_LOG_DEBUG << "No added sources, "
+			                  << "retry existing sources instead";
 		}
 	}
 
-	fc_logger().debug() << "Selected sources so far "
-	                    << selsrc_size << "/" << _potential_sources.size();
+	LAZY_FC_LOG_DEBUG << "Selected sources so far "
+	                  << selsrc_size << "/" << _potential_sources.size();
 
-	URECommons urec(_as);
-	map<Handle, float> tournament_elem;
+	FitnessIndex& to_select_sources =
+		_unselected_sources.empty() ? _potential_fitness : _unselected_fitness;
+	Handle hchosen = to_select_sources.tournament_select();
 
-	const UnorderedHandleSet& to_select_sources =
-		_unselected_sources.empty() ? _potential_sources : _unselected_sources;
+	OC_ASSERT(hchosen != Handle::UNDEFINED);
 
-	Handle hchosen;
-	switch (_ts_mode) {
-	case source_selection_mode::TV_FITNESS:
-	    for (const Handle& s : to_select_sources)
-		    tournament_elem[s] = urec.tv_fitness(s);
-	    hchosen = urec.tournament_select(tournament_elem);
-	    break;
+	_selected_sources.insert(hchosen);
+	_unselected_sources.erase(hchosen);
+	_unselected_fitness.erase(hchosen);
 
-	case source_selection_mode::STI:
-	    for (const Handle& s : to_select_sources)
-		    tournament_elem[s] = s->getSTI();
-	    hchosen = urec.tournament_select(tournament_elem);
-	    break;
+	return hchosen;
+}
 
-	case source_selection_mode::UNIFORM:
-		hchosen = rand_element(to_select_sources);
-	    break;
+/**
+ * The fitness of a source, according to the source selection mode.
+ * All sources are equally fit in UNIFORM mode.
+ */
+float ForwardChainer::source_fitness(const Handle& h) const
+{
+    switch (_ts_mode) {
+    case source_selection_mode::TV_FITNESS:
+        return _rec.tv_fitness(h);
 
-	default:
-	    throw RuntimeException(TRACE_INFO, "Unknown source selection mode.");
-	    break;
-	}
+    case source_selection_mode::STI:
+        return h->getSTI();
 
-	OC_ASSERT(hchosen != Handle::UNDEFINED);
-	
-	_selected_sources.insert(hchosen);
-	_unselected_sources.erase(hchosen);
+    case source_selection_mode::UNIFORM:
+        return 0;
 
-	return hchosen;
+    default:
+        throw RuntimeException(TRACE_INFO, "Unknown source selection mode.");
+    }
+}
+
+void ForwardChainer::update_source_fitness(const Handle& h)
+{
+    float fitness = source_fitness(h);
+    _potential_fitness.update(h, fitness);
+    _unselected_fitness.update(h, fitness);
 }
 
 const Rule* ForwardChainer::select_rule(const Handle& hsource)
 {
+    // Only the rules with a premise that the source might ground are
+    // candidates.
     std::map<const Rule*, float> rule_weight;
-    for (const Rule& r : _rules)
-        rule_weight[&r] = r.get_weight();
+    std::map<const Rule*, std::vector<const PremiseIndex::Entry*>> premises;
+    for (const PremiseIndex::Entry* entry : _premise_index.lookup(hsource)) {
+        rule_weight[entry->rule] = entry->rule->get_weight();
+        premises[entry->rule].push_back(entry);
+    }
+
+    // Exact premises are unified in place, unless the source holds
+    // variables; the others need the pattern matcher.
+    bool closed = not contains_atomtype(hsource, VARIABLE_NODE);
 
     fc_logger().debug("%d rules to be searched as matched against the source",
                       rule_weight.size());
@@ -266,8 +442,11 @@ const Rule* ForwardChainer::select_rule(const Handle& hsource)
                          temp->get_name().c_str());
 
         bool unified = false;
-        for (Handle premise_pat : temp->get_premises()) {
-            if (unify(hsource, premise_pat, *temp)) {
+        for (const PremiseIndex::Entry* entry : premises[temp]) {
+            bool match = (entry->exact and closed) ?
+                PremiseIndex::match(*entry, hsource) :
+                unify(hsource, entry->premise, *temp);
+            if (match) {
                 rule = temp;
                 unified = true;
                 break;
@@ -312,7 +491,34 @@ UnorderedHandleSet ForwardChainer::apply_rule(const Rule& rule)
     return products;
 }
 
+/**
+ * Apply all the rules derived from @param rule and @param source,
+ * creating the products in @param as, a child of _as.  Nothing else
+ * is written to, so that several of these may run at once.
+ */
+HandleSeq ForwardChainer::ground_rule(AtomSpace& as, const Handle& source,
+                                      const Rule& rule)
+{
+    HandleSeq products;
+    for (const Handle& rhandle : derive_rules(source, rule)) {
+        HandleSeq hs = ground_rule(as, rhandle);
+        products.insert(products.end(), hs.begin(), hs.end());
+    }
+    return products;
+}
+
 HandleSeq ForwardChainer::apply_rule(const Handle& rhandle)
+{
+    HandleSeq result = ground_rule(_as, rhandle);
+    add_results(result);
+    return result;
+}
+
+/**
+ * Apply rule handle (BindLink), creating the products in @param as,
+ * which is either _as or a child of it.
+ */
+HandleSeq ForwardChainer::ground_rule(AtomSpace& as, const Handle& rhandle)
 {
     HandleSeq result;
 
@@ -329,14 +535,14 @@ HandleSeq ForwardChainer::apply_rule(const Handle& rhandle)
             hs.push_back(implicant);
         // Actual checking here.
         for (const Handle& h : hs) {
-            if (_as.get_atom(h) == Handle::UNDEFINED
+            if (as.get_atom(h) == Handle::UNDEFINED
                 or (_search_focus_set
                     and _focus_set_as.get_atom(h) == Handle::UNDEFINED)) {
                 return {};
             }
         }
 
-        Instantiator inst(&_as);
+        Instantiator inst(&as);
         Handle houtput = rhandle->getOutgoingSet().back();
         LAZY_FC_LOG_DEBUG << "Instantiating " << houtput->toShortString();
 
@@ -357,7 +563,7 @@ HandleSeq ForwardChainer::apply_rule(const Handle& rhandle)
 
             BindLinkPtr bl = BindLinkCast(rhcpy);
 
-            FocusSetPMCB fs_pmcb(&derived_rule_as, &_as);
+            FocusSetPMCB fs_pmcb(&derived_rule_as, &as);
             fs_pmcb.implicand = bl->get_implicand();
 
             LAZY_FC_LOG_DEBUG << "In focus set, apply rule:" << std::endl
@@ -369,7 +575,7 @@ HandleSeq ForwardChainer::apply_rule(const Handle& rhandle)
         }
         // Search the whole atomspace.
         else {
-            AtomSpace derived_rule_as(&_as);
+            AtomSpace derived_rule_as(&as);
 
             Handle rhcpy = derived_rule_as.add_atom(rhandle);
 
@@ -382,34 +588,41 @@ HandleSeq ForwardChainer::apply_rule(const Handle& rhandle)
         }
     }
 
-    // Take the results from applying the rule and add them in the
-    // given AtomSpace
-    auto add_results = [](AtomSpace& as, HandleSeq& result) {
-	    for (Handle& h : result)
-	    {
-		    Type t = h->getType();
-		    // If it's a List then add all the results. That kinda
-		    // means you can't infer List itself, maybe something to
-		    // look after.
-		    if (t == LIST_LINK)
-			    for (const Handle& hc : h->getOutgoingSet())
-				    as.add_atom(hc);
-		    else
-			    h = as.add_atom(h);
-	    }
-    };
+    return result;
+}
 
-    // Add result back to atomspace.
-    if (_search_focus_set) {
-	    add_results(_focus_set_as, result);
-    } else {
-	    add_results(_as, result);
+/**
+ * Take the results from applying a rule and add them in _as, or in
+ * the focus set atomspace when searching the focus set.  If they
+ * belong to a scratch atomspace that is about to go away, set
+ * from_scratch, so that none of them is left pointing into it.
+ */
+void ForwardChainer::add_results(HandleSeq& result, bool from_scratch)
+{
+    AtomSpace& as = _search_focus_set ? _focus_set_as : _as;
+    for (Handle& h : result)
+    {
+        Type t = h->getType();
+        // If it's a List then add all the results. That kinda
+        // means you can't infer List itself, maybe something to
+        // look after.
+        if (t == LIST_LINK) {
+            HandleSeq copies;
+            for (const Handle& hc : h->getOutgoingSet())
+                copies.push_back(as.add_atom(hc));
+
+            // The List stays out of the atomspace, but must not hold
+            // on to the scratch one either.
+            if (from_scratch)
+                h = Handle(createLink(LIST_LINK, copies));
+        }
+        else
+            h = as.add_atom(h);
     }
 
+    // Not added to the atomspace, where the rules could match it.
     LAZY_FC_LOG_DEBUG << "Result is:" << std::endl
-                      << _as.add_link(SET_LINK, result)->toShortString();
-
-    return result;
+                      << Handle(createLink(SET_LINK, result))->toShortString();
 }
 
 /**
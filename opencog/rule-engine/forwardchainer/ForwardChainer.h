@@ -24,10 +24,15 @@
 #ifndef FORWARDCHAINERX_H_
 #define FORWARDCHAINERX_H_
 
+#include <memory>
+
 #include <opencog/rule-engine/URECommons.h>
 #include <opencog/rule-engine/UREConfigReader.h>
 
 #include "FCStat.h"
+#include "FitnessIndex.h"
+#include "PremiseIndex.h"
+#include "ReteNetwork.h"
 
 class ForwardChainerUTest;
 
@@ -61,9 +66,11 @@ private:
 
     int _iteration;
     int _max_iteration;
+    size_t _batch_size;
     source_selection_mode _ts_mode;
     bool _search_in_af;
     bool _search_focus_set;
+    bool _dump_trace;
     Handle _cur_source;
 
     // We maintain both selected and unselected sources, to speed up
@@ -71,11 +78,34 @@ private:
     UnorderedHandleSet _selected_sources;
     UnorderedHandleSet _unselected_sources;
 
+    // The fitnesses of the unselected and of all the potential
+    // sources, for select_source(), updated when their TVs or AVs
+    // change.
+    FitnessIndex _unselected_fitness;
+    FitnessIndex _potential_fitness;
+    std::vector<boost::signals2::connection> _fitness_connections;
+
     FCStat _fcstat;
 
+    // The premises of the rules, indexed for select_rule()
+    PremiseIndex _premise_index;
+
+    // The rule bodies, matched as atoms come and go, for
+    // apply_all_rules(), if URE:FC-incremental is set.
+    std::unique_ptr<ReteNetwork> _rete;
+
     void init(const Handle& hsource, const HandleSeq& focus_set);
 
     void apply_all_rules();
+    void apply_all_rules_incremental();
+
+    HandleSeq ground_rule(AtomSpace& as, const Handle& rhandle);
+    HandleSeq ground_rule(AtomSpace& as, const Handle& source,
+                          const Rule& rule);
+    void add_results(HandleSeq& result, bool from_scratch = false);
+
+    float source_fitness(const Handle& h) const;
+    void update_source_fitness(const Handle& h);
 
     Handle gen_sub_varlist(const Handle& parent, const Handle& parent_varlist);
     bool is_constant_clause(const Handle& hvarlist, const Handle& hclause) const;
@@ -100,6 +130,11 @@ private:
                                   input_minus_selected.end());
         _unselected_sources.insert(input_minus_selected.begin(),
                                    input_minus_selected.end());
+        for (const Handle& h : input_minus_selected) {
+            float fitness = source_fitness(h);
+            _potential_fitness.insert(h, fitness);
+            _unselected_fitness.insert(h, fitness);
+        }
     }
     bool is_valid_implicant(const Handle& h);
     void validate(const Handle& hsource, const HandleSeq& hfocus_set);
@@ -156,9 +191,17 @@ public:
      */
     void do_step();
 
+    /**
+     * Perform several forward chaining inference steps, applying
+     * their rules concurrently.  The number of steps is set by the
+     * URE:FC-batch-size parameter of the rule-based system.
+     */
+    void do_batch_step();
+
     /**
      * Perform forward chaining inference till the termination
-     * criteria have been met.
+     * criteria have been met.  Uses do_batch_step() if the batch
+     * size is above 1, else do_step().
      */
     void do_chain();
 
@@ -167,6 +210,13 @@ public:
      */
     bool termination();
 
+    /**
+     * Write the inference trace recorded so far in the atomspace, as
+     * described in FCStat::dump_trace().  do_chain() does so when it
+     * is done, unless URE:FC-dump-trace is set to false.
+     */
+    void dump_trace();
+
     /**
      * @return all results in their order of inference.
      */
@@ -0,0 +1,233 @@
+/*
+ * PremiseIndex.cc
+ *
+ * Copyright (C) 2016 OpenCog Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <opencog/atoms/base/ClassServer.h>
+#include <opencog/atoms/base/atom_types.h>
+#include <opencog/atomutils/FindUtils.h>
+
+#include "PremiseIndex.h"
+
+using namespace opencog;
+
+bool PremiseIndex::Key::operator<(const Key& other) const
+{
+    if (type != other.type) return type < other.type;
+    if (arity != other.arity) return arity < other.arity;
+    return name < other.name;
+}
+
+/**
+ * Types that the pattern matcher does not ground by plain structural
+ * comparison: these it evaluates, unquotes, alpha-converts, or treats
+ * as choices or globs.
+ */
+static bool is_special_type(Type t)
+{
+    ClassServer& cs = classserver();
+    if (EVALUATION_LINK != t and cs.isA(t, EVALUATABLE_LINK)) return true;
+
+    return cs.isA(t, SCOPE_LINK) or cs.isA(t, VIRTUAL_LINK)
+        or cs.isA(t, FUNCTION_LINK)
+        or QUOTE_LINK == t or UNQUOTE_LINK == t or LOCAL_QUOTE_LINK == t
+        or CHOICE_LINK == t or STATE_LINK == t
+        or GLOB_NODE == t
+        or DEFINED_SCHEMA_NODE == t or DEFINED_PREDICATE_NODE == t
+        or GROUNDED_SCHEMA_NODE == t or GROUNDED_PREDICATE_NODE == t;
+}
+
+bool PremiseIndex::is_exact(const Handle& h, const Variables& vars)
+{
+    if (is_special_type(h->getType())) return false;
+    if (not h->isLink()) return true;
+
+    // Unordered links are grounded by trying permutations.
+    if (classserver().isA(h->getType(), UNORDERED_LINK)
+        and any_unquoted_unscoped_in_tree(h, vars.varset))
+        return false;
+
+    for (const Handle& child : h->getOutgoingSet())
+        if (not is_exact(child, vars))
+            return false;
+    return true;
+}
+
+void PremiseIndex::premise_keys(const Handle& h, const Variables& vars,
+                                std::vector<Key>& keys)
+{
+    if (vars.is_in_varset(h)) {
+        keys.push_back({NOTYPE, 0, ""});
+        return;
+    }
+
+    if (not h->isLink()) {
+        keys.push_back({h->getType(), 0, h->getName()});
+        return;
+    }
+
+    keys.push_back({h->getType(), h->getArity(), ""});
+    for (const Handle& child : h->getOutgoingSet())
+        premise_keys(child, vars, keys);
+}
+
+void PremiseIndex::source_keys(const Handle& h, std::vector<Key>& keys,
+                               std::vector<size_t>& next)
+{
+    size_t i = keys.size();
+    next.push_back(0);
+
+    if (h->isLink()) {
+        keys.push_back({h->getType(), h->getArity(), ""});
+        for (const Handle& child : h->getOutgoingSet())
+            source_keys(child, keys, next);
+    } else {
+        keys.push_back({h->getType(), 0, h->getName()});
+    }
+
+    // Where a wildcard standing for this subtree resumes.
+    next[i] = keys.size();
+}
+
+void PremiseIndex::insert(const Rule* rule, const Handle& premise,
+                          const Handle& vardecl)
+{
+    VariableListPtr vl = VariableListCast(vardecl);
+    if (nullptr == vl)
+        vl = createVariableList(vardecl->getOutgoingSet());
+    const Variables& vars = vl->get_variables();
+
+    Entry entry{rule, premise, vl,
+                not vars.is_in_varset(premise) and is_exact(premise, vars)};
+
+    // Premises that are not exact go under a single wildcard; their
+    // structure says little about what the pattern matcher accepts.
+    std::vector<Key> keys;
+    if (entry.exact)
+        premise_keys(premise, vars, keys);
+    else
+        keys.push_back({NOTYPE, 0, ""});
+
+    TrieNode* node = &_root;
+    for (const Key& key : keys) {
+        std::unique_ptr<TrieNode>& child = node->children[key];
+        if (nullptr == child)
+            child.reset(new TrieNode());
+        node = child.get();
+    }
+
+    node->entries.push_back(_entries.size());
+    _entries.push_back(entry);
+}
+
+void PremiseIndex::clear()
+{
+    _entries.clear();
+    _root.children.clear();
+    _root.entries.clear();
+}
+
+void PremiseIndex::collect(const TrieNode& node, const std::vector<Key>& keys,
+                           const std::vector<size_t>& next, size_t i,
+                           std::vector<bool>& seen,
+                           std::vector<const Entry*>& result) const
+{
+    if (keys.size() == i) {
+        for (size_t e : node.entries) {
+            if (seen[e]) continue;
+            seen[e] = true;
+            result.push_back(&_entries[e]);
+        }
+        return;
+    }
+
+    static const Key wildcard{NOTYPE, 0, ""};
+    auto it = node.children.find(wildcard);
+    if (node.children.end() != it)
+        collect(*it->second, keys, next, next[i], seen, result);
+
+    it = node.children.find(keys[i]);
+    if (node.children.end() != it)
+        collect(*it->second, keys, next, i + 1, seen, result);
+}
+
+std::vector<const PremiseIndex::Entry*>
+PremiseIndex::lookup(const Handle& source) const
+{
+    std::vector<const Entry*> result;
+
+    // Variables in the source may themselves be grounded by the
+    // premise; leave that to the pattern matcher.
+    if (contains_atomtype(source, VARIABLE_NODE)) {
+        for (const Entry& entry : _entries)
+            result.push_back(&entry);
+        return result;
+    }
+
+    std::vector<Key> keys;
+    std::vector<size_t> next;
+    source_keys(source, keys, next);
+
+    std::vector<bool> seen(_entries.size(), false);
+    collect(_root, keys, next, 0, seen, result);
+    return result;
+}
+
+bool PremiseIndex::match(const Handle& pat, const Handle& src,
+                         const Variables& vars, HandleMap& bindings)
+{
+    if (vars.is_in_varset(pat)) {
+        auto it = bindings.find(pat);
+        if (bindings.end() != it)
+            return content_eq(it->second, src);
+        if (not vars.is_type(pat, src))
+            return false;
+        bindings[pat] = src;
+        return true;
+    }
+
+    if (pat->getType() != src->getType()) return false;
+    if (not pat->isLink()) return content_eq(pat, src);
+
+    // Exact premises hold no variables under unordered links.
+    if (classserver().isA(pat->getType(), UNORDERED_LINK))
+        return content_eq(pat, src);
+
+    const HandleSeq& pset = pat->getOutgoingSet();
+    const HandleSeq& sset = src->getOutgoingSet();
+    if (pset.size() != sset.size()) return false;
+
+    for (size_t i = 0; i < pset.size(); i++)
+        if (not match(pset[i], sset[i], vars, bindings))
+            return false;
+    return true;
+}
+
+bool PremiseIndex::match(const Entry& entry, const Handle& source)
+{
+    HandleMap bindings;
+    return match(entry, source, bindings);
+}
+
+bool PremiseIndex::match(const Entry& entry, const Handle& source,
+                         HandleMap& bindings)
+{
+    return match(entry.premise, source, entry.vardecl->get_variables(),
+                 bindings);
+}
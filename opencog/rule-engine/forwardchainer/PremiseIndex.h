@@ -0,0 +1,128 @@
+/*
+ * PremiseIndex.h
+ *
+ * Copyright (C) 2016 OpenCog Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_PREMISE_INDEX_H
+#define _OPENCOG_PREMISE_INDEX_H
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <opencog/atoms/base/Handle.h>
+#include <opencog/atoms/core/VariableList.h>
+
+namespace opencog
+{
+
+class Rule;
+
+/**
+ * Index of the rule premises, used by the forward chainer to find the
+ * rules that a source might match, without running the pattern
+ * matcher against every premise of every rule.
+ *
+ * The premises are stored in a discrimination tree, keyed on the
+ * preorder sequence of their atoms: (type, name) for nodes and
+ * (type, arity) for links.  A declared variable is a wildcard, which
+ * skips over the whole subtree of the source that it faces.  A lookup
+ * thus returns every premise that the source could possibly ground,
+ * and usually not many more.
+ *
+ * Premises made only of ordered links, constants and typed variables
+ * are "exact": for those, match() decides unification by walking the
+ * two trees side by side.  All other premises (ones with quotations,
+ * scopes, globs, evaluatable or unordered terms holding variables)
+ * are indexed under a single wildcard, and must be checked with the
+ * pattern matcher, as before.
+ */
+class PremiseIndex
+{
+public:
+    struct Entry
+    {
+        const Rule* rule;
+        Handle premise;
+        VariableListPtr vardecl;
+        bool exact;
+    };
+
+    /// Add a premise of a rule; vardecl declares its variables.
+    void insert(const Rule* rule, const Handle& premise,
+                const Handle& vardecl);
+
+    void clear();
+
+    /// The entries whose premise might be grounded by the source.
+    /// A source holding variables matches every entry.
+    std::vector<const Entry*> lookup(const Handle& source) const;
+
+    /// Unify the source with an exact entry.  Must not be called on
+    /// entries that are not exact, or with sources holding free
+    /// variables; bound ones are compared like any other atom.
+    static bool match(const Entry& entry, const Handle& source);
+
+    /// Same as above, also returning the groundings of the variables.
+    static bool match(const Entry& entry, const Handle& source,
+                      HandleMap& bindings);
+
+    size_t size() const { return _entries.size(); }
+
+    /// The i-th entry inserted.
+    const Entry& entry(size_t i) const { return _entries[i]; }
+
+private:
+    /// A preorder key; NOTYPE is the wildcard.
+    struct Key
+    {
+        Type type;
+        Arity arity;
+        std::string name;
+
+        bool operator<(const Key&) const;
+    };
+
+    struct TrieNode
+    {
+        std::map<Key, std::unique_ptr<TrieNode>> children;
+        std::vector<size_t> entries;
+    };
+
+    std::vector<Entry> _entries;
+    TrieNode _root;
+
+    static bool is_exact(const Handle& premise, const Variables& vars);
+    static void premise_keys(const Handle& h, const Variables& vars,
+                             std::vector<Key>& keys);
+    static void source_keys(const Handle& h, std::vector<Key>& keys,
+                            std::vector<size_t>& next);
+    static bool match(const Handle& pat, const Handle& src,
+                      const Variables& vars, HandleMap& bindings);
+
+    void collect(const TrieNode& node, const std::vector<Key>& keys,
+                 const std::vector<size_t>& next, size_t i,
+                 std::vector<bool>& seen,
+                 std::vector<const Entry*>& result) const;
+};
+
+} // ~namespace opencog
+
+#endif // _OPENCOG_PREMISE_INDEX_H
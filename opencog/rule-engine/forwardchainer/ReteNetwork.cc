@@ -0,0 +1,288 @@
+/*
+ * ReteNetwork.cc
+ *
+ * Copyright (C) 2016 OpenCog Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <algorithm>
+
+#include <opencog/atoms/base/atom_types.h>
+#include <opencog/atoms/execution/EvaluationLink.h>
+#include <opencog/atomutils/FindUtils.h>
+#include <opencog/atomutils/Substitutor.h>
+#include <opencog/atomutils/Unify.h>
+#include <opencog/rule-engine/Rule.h>
+
+#include "ReteNetwork.h"
+
+using namespace opencog;
+
+ReteNetwork::ReteNetwork(AtomSpace& as, const RuleSet& rules) : _as(as)
+{
+    std::vector<Clause> owners;
+    for (const Rule& rule : rules)
+        compile(rule, owners);
+
+    // The entries only stay put once all the clauses are in.
+    for (size_t i = 0; i < owners.size(); i++) {
+        const PremiseIndex::Entry& entry = _index.entry(i);
+        _clauses[&entry] = owners[i];
+        if (not entry.exact)
+            _productions[owners[i].production].compiled = false;
+    }
+
+    // Connect first, so that no atom slips in between; the atoms seen
+    // twice are skipped.
+    _add_connection = _as.addAtomSignal(
+        [this](const Handle& h) { add_atom(h); });
+    _remove_connection = _as.removeAtomSignal(
+        [this](const AtomPtr& atom) { remove_atom(Handle(atom)); });
+
+    HandleSeq atoms;
+    _as.get_all_atoms(atoms);
+    for (const Handle& h : atoms)
+        add_atom(h);
+}
+
+ReteNetwork::~ReteNetwork()
+{
+    _add_connection.disconnect();
+    _remove_connection.disconnect();
+}
+
+/**
+ * Evaluatable terms that EvaluationLink::do_eval_scratch() decides
+ * from the groundings alone.
+ */
+bool ReteNetwork::is_filter(const Handle& h)
+{
+    Type t = h->getType();
+    if (NOT_LINK == t or AND_LINK == t or OR_LINK == t) {
+        for (const Handle& child : h->getOutgoingSet())
+            if (not is_filter(child))
+                return false;
+        return true;
+    }
+
+    if (EVALUATION_LINK == t)
+        return 2 == h->getArity()
+            and GROUNDED_PREDICATE_NODE == h->getOutgoingAtom(0)->getType();
+
+    return IDENTICAL_LINK == t or EQUAL_LINK == t or GREATER_THAN_LINK == t;
+}
+
+void ReteNetwork::compile(const Rule& rule, std::vector<Clause>& owners)
+{
+    Handle body = rule.get_forward_implicant();
+    Handle vardecl(gen_varlist(body, rule.get_forward_vardecl()));
+
+    HandleSeq conjuncts;
+    if (AND_LINK == body->getType())
+        conjuncts = body->getOutgoingSet();
+    else
+        conjuncts.push_back(body);
+
+    _productions.push_back({&rule, true, {}, {}, {}, {}});
+    Production& p = _productions.back();
+
+    OrderedHandleSet bound;
+    for (const Handle& conjunct : conjuncts) {
+        if (is_filter(conjunct)) {
+            p.filters.push_back(conjunct);
+            continue;
+        }
+        owners.push_back({_productions.size() - 1, p.clauses.size()});
+        _index.insert(&rule, conjunct, vardecl);
+        p.clauses.push_back(conjunct);
+
+        OrderedHandleSet vars = get_free_variables(conjunct);
+        bound.insert(vars.begin(), vars.end());
+    }
+
+    // The filters can only be evaluated once all their variables are
+    // grounded by the clauses.
+    for (const Handle& filter : p.filters)
+        for (const Handle& var : get_free_variables(filter))
+            if (0 == bound.count(var))
+                p.compiled = false;
+
+    if (p.clauses.empty())
+        p.compiled = false;
+
+    p.alpha.resize(p.clauses.size());
+    p.beta.resize(p.clauses.size());
+}
+
+bool ReteNetwork::is_compiled(const Rule& rule) const
+{
+    for (const Production& p : _productions)
+        if (p.rule == &rule)
+            return p.compiled;
+    return false;
+}
+
+bool ReteNetwork::join(const Token& left, const Token& right, Token& out)
+{
+    out = left;
+    for (const auto& vg : right.groundings) {
+        auto it = out.groundings.find(vg.first);
+        if (out.groundings.end() == it)
+            out.groundings.insert(vg);
+        else if (not content_eq(it->second, vg.second))
+            return false;
+    }
+    out.atoms.insert(out.atoms.end(), right.atoms.begin(), right.atoms.end());
+    return true;
+}
+
+void ReteNetwork::add_atom(const Handle& h)
+{
+    // Free variables in the atom may themselves be grounded by the
+    // clauses, which only the pattern matcher knows how to deal with.
+    // Closed atoms, such as scope links, are matched like any other:
+    // exact clauses hold no scope links, so their bound variables only
+    // ever face a clause variable, which takes the whole subtree.
+    if (contains_atomtype(h, VARIABLE_NODE) and not is_closed(h)) return;
+
+    std::lock_guard<std::mutex> lock(_mtx);
+    if (not _seen.insert(h).second) return;
+
+    for (const PremiseIndex::Entry* entry : _index.lookup(h)) {
+        const Clause& c = _clauses.at(entry);
+        if (not _productions[c.production].compiled) continue;
+
+        Token token;
+        if (not PremiseIndex::match(*entry, h, token.groundings)) continue;
+        token.atoms.push_back(h);
+        activate(c.production, c.clause, token);
+    }
+}
+
+/**
+ * Join a new grounding of a clause with the groundings of the clauses
+ * before it, then extend the result through the clauses after it.
+ */
+void ReteNetwork::activate(size_t production, size_t clause,
+                           const Token& token)
+{
+    Production& p = _productions[production];
+    p.alpha[clause].push_back(token);
+
+    std::vector<Token> partial;
+    if (0 == clause) {
+        partial.push_back(token);
+    } else {
+        for (const Token& left : p.beta[clause - 1]) {
+            Token joined;
+            if (join(left, token, joined))
+                partial.push_back(joined);
+        }
+    }
+
+    for (size_t k = clause; not partial.empty(); k++) {
+        if (k + 1 == p.clauses.size()) {
+            for (Token& complete : partial)
+                _pending.push_back({production, std::move(complete)});
+            break;
+        }
+
+        p.beta[k].insert(p.beta[k].end(), partial.begin(), partial.end());
+
+        std::vector<Token> next;
+        for (const Token& left : partial) {
+            for (const Token& right : p.alpha[k + 1]) {
+                Token joined;
+                if (join(left, right, joined))
+                    next.push_back(joined);
+            }
+        }
+        partial.swap(next);
+    }
+}
+
+void ReteNetwork::remove_atom(const Handle& h)
+{
+    std::lock_guard<std::mutex> lock(_mtx);
+    if (0 == _seen.erase(h)) return;
+
+    auto holds = [&h](const Token& t) {
+        return t.atoms.end() != std::find(t.atoms.begin(), t.atoms.end(), h);
+    };
+
+    // Only the memories from the clauses it grounds onwards may hold it.
+    for (const PremiseIndex::Entry* entry : _index.lookup(h)) {
+        const Clause& c = _clauses.at(entry);
+        Production& p = _productions[c.production];
+        if (not p.compiled) continue;
+
+        for (size_t k = c.clause; k < p.clauses.size(); k++) {
+            for (std::vector<Token>* memory : {&p.alpha[k], &p.beta[k]})
+                memory->erase(std::remove_if(memory->begin(), memory->end(),
+                                             holds),
+                              memory->end());
+        }
+    }
+
+    _pending.erase(std::remove_if(_pending.begin(), _pending.end(),
+                                  [&holds](const Pending& pd) {
+                                      return holds(pd.token);
+                                  }),
+                   _pending.end());
+}
+
+bool ReteNetwork::accept(const Production& p, const HandleMap& groundings,
+                         AtomSpace* scratch) const
+{
+    for (const Handle& filter : p.filters) {
+        scratch->clear();
+        Handle grounded = Substitutor::substitute(filter, groundings);
+        TruthValuePtr tv =
+            EvaluationLink::do_eval_scratch(&_as, grounded, scratch, true);
+        if (nullptr == tv or tv->getMean() <= 0.5)
+            return false;
+    }
+    return true;
+}
+
+std::vector<ReteNetwork::Match> ReteNetwork::take_matches()
+{
+    std::vector<Pending> pending;
+    {
+        std::lock_guard<std::mutex> lock(_mtx);
+        pending.swap(_pending);
+    }
+
+    // The filters are evaluated outside of the lock, as they may call
+    // into scheme or python, which may in turn add atoms.
+    std::vector<Match> matches;
+    AtomSpace* scratch = AtomSpace::grab_transient(&_as);
+    for (Pending& pd : pending) {
+        const Production& p = _productions[pd.production];
+        if (accept(p, pd.token.groundings, scratch))
+            matches.push_back({p.rule, std::move(pd.token.groundings),
+                               std::move(pd.token.atoms)});
+    }
+    AtomSpace::release_transient(scratch);
+    return matches;
+}
+
+size_t ReteNetwork::pending() const
+{
+    std::lock_guard<std::mutex> lock(_mtx);
+    return _pending.size();
+}
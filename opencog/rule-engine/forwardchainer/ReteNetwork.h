@@ -0,0 +1,154 @@
+/*
+ * ReteNetwork.h
+ *
+ * Copyright (C) 2016 OpenCog Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_RETE_NETWORK_H
+#define _OPENCOG_RETE_NETWORK_H
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/signals2/connection.hpp>
+
+#include <opencog/atomspace/AtomSpace.h>
+
+#include "PremiseIndex.h"
+
+namespace opencog
+{
+
+class Rule;
+class RuleSet;
+
+/**
+ * Incremental matcher of the rule bodies, in the manner of a Rete
+ * network, so that the forward chainer need not run the pattern
+ * matcher over the whole atomspace each time it applies all rules.
+ *
+ * The clauses of all the rules are compiled into a single PremiseIndex,
+ * which plays the part of the alpha network: an added atom is looked
+ * up once, and unified with the clauses it might ground.  Each rule
+ * then keeps, per clause, the atoms grounding it (alpha memories), and
+ * the consistent groundings of its first k clauses (beta memories).
+ * A new atom is joined with the memories on either side of the clauses
+ * it grounds; a removed one is dropped from the memories that hold it.
+ * The cost of either is thus proportional to the partial matches it
+ * takes part in, not to the size of the atomspace.
+ *
+ * Only rules whose body is a conjunction of exact clauses (see
+ * PremiseIndex) are compiled.  Evaluatable clauses made of NotLink,
+ * AndLink, OrLink, IdenticalLink, EqualLink, GreaterThanLink and
+ * grounded predicates are also accepted, as long as their variables
+ * appear in the other clauses: these are evaluated on complete matches,
+ * when they are taken.  Other rules must be applied with the pattern
+ * matcher, as before.  Atoms with free variables, such as the clauses
+ * of the rules themselves, are never matched.  The pattern matcher
+ * does not ground a clause with its own variables either, but it may
+ * ground one with atoms holding other free variables, which the
+ * network thus misses.
+ *
+ * The network follows the add and remove signals of the atomspace it
+ * is built over, and may be fed by several threads at once.
+ */
+class ReteNetwork
+{
+public:
+    /// A complete grounding of the body of a rule.
+    struct Match
+    {
+        const Rule* rule;
+        HandleMap groundings;
+        HandleSeq atoms;        // the atoms grounding each clause
+    };
+
+    /// Compile the rules, match them against the atoms already in as,
+    /// then follow the atoms added to or removed from it.  The rules
+    /// must outlive the network.
+    ReteNetwork(AtomSpace& as, const RuleSet& rules);
+    ~ReteNetwork();
+    ReteNetwork(const ReteNetwork&) = delete;
+    ReteNetwork& operator=(const ReteNetwork&) = delete;
+
+    /// True if the rule is matched by the network.
+    bool is_compiled(const Rule& rule) const;
+
+    /// Remove and return the matches completed since the last call,
+    /// in the order they were completed, minus those rejected by the
+    /// evaluatable clauses of their rule.
+    std::vector<Match> take_matches();
+
+    /// Number of matches completed since the last take_matches().
+    size_t pending() const;
+
+private:
+    struct Token
+    {
+        HandleMap groundings;
+        HandleSeq atoms;
+    };
+
+    struct Production
+    {
+        const Rule* rule;
+        bool compiled;
+        HandleSeq clauses;      // joined, in this order
+        HandleSeq filters;      // evaluated on complete matches
+        std::vector<std::vector<Token>> alpha;
+        std::vector<std::vector<Token>> beta;   // beta[k] joins 0..k
+    };
+
+    struct Pending
+    {
+        size_t production;
+        Token token;
+    };
+
+    // Where an entry of the index leads: a clause of a production.
+    struct Clause
+    {
+        size_t production;
+        size_t clause;
+    };
+
+    AtomSpace& _as;
+    PremiseIndex _index;
+    std::vector<Production> _productions;
+    std::unordered_map<const PremiseIndex::Entry*, Clause> _clauses;
+    UnorderedHandleSet _seen;
+    std::vector<Pending> _pending;
+    mutable std::mutex _mtx;
+    boost::signals2::connection _add_connection;
+    boost::signals2::connection _remove_connection;
+
+    static bool is_filter(const Handle& h);
+    static bool join(const Token& left, const Token& right, Token& out);
+
+    void compile(const Rule& rule, std::vector<Clause>& owners);
+    void add_atom(const Handle& h);
+    void remove_atom(const Handle& h);
+    void activate(size_t production, size_t clause, const Token& token);
+    bool accept(const Production& p, const HandleMap& groundings,
+                AtomSpace* scratch) const;
+};
+
+} // ~namespace opencog
+
+#endif // _OPENCOG_RETE_NETWORK_H
@@ -330,6 +330,73 @@
     ordinary scheme list.
 ")
 
+(set-procedure-property! cog-outgoing-vector 'documentation
+"
+ cog-outgoing-vector ATOM
+    Return the outgoing set of ATOM, as a scheme vector.  This is the
+    same as (list->vector (cog-outgoing-set ATOM)), but faster.
+")
+
+(set-procedure-property! cog-incoming-vector 'documentation
+"
+ cog-incoming-vector ATOM
+    Return the incoming set of ATOM, as a scheme vector.  The order
+    of the atoms in the vector is not specified.
+")
+
+(set-procedure-property! cog-incoming-by-type-vector 'documentation
+"
+ cog-incoming-by-type-vector ATOM TYPE
+    Return those links in the incoming set of ATOM that are of type
+    TYPE, as a scheme vector.
+")
+
+(set-procedure-property! cog-get-atoms-vector 'documentation
+"
+ cog-get-atoms-vector TYPE [SUBTYPES]
+    Return all atoms in the current atomspace that are of type TYPE,
+    as a scheme vector.  If SUBTYPES is given, and is not #f, then
+    atoms of all subtypes of TYPE are returned, as well.  This is much
+    faster than cog-get-atoms, as it never calls back into scheme.
+
+    Example:
+       guile> (vector-length (cog-get-atoms-vector 'Node #t))
+")
+
+(set-procedure-property! cog-new-tree 'documentation
+"
+ cog-new-tree TREE [ATOMSPACE]
+    Create all of the atoms in TREE, and return the atom at its root.
+    TREE is an s-expression of the form (TYPE ARG ...) where TYPE is
+    the name of an atom type.  For nodes, the first ARG is the name of
+    the node.  For links, each ARG is either an atom or another TREE.
+    A truth value or attention value may appear amongst the ARGs.
+
+    The whole tree is created in one call, without creating scheme
+    objects for any of the atoms inside it; this makes it much faster
+    than evaluating the equivalent nested cog-new-link expressions.
+
+    Example:
+       guile> (cog-new-tree '(ListLink (ConceptNode \"a\") (ConceptNode \"b\")))
+       (ListLink
+          (ConceptNode \"a\")
+          (ConceptNode \"b\")
+       )
+
+       ; Quasi-quote to include truth values or existing atoms:
+       guile> (define x (ConceptNode \"x\"))
+       guile> (cog-new-tree `(ListLink ,x (ConceptNode \"y\" ,(stv 0.5 0.5))))
+")
+
+(set-procedure-property! cog-new-trees 'documentation
+"
+ cog-new-trees LIST-OF-TREES [ATOMSPACE]
+    Create all of the atoms in each tree in LIST-OF-TREES; see
+    cog-new-tree for the form of each tree.  Returns the number of
+    trees created, and not the atoms themselves.  This is intended
+    for loading large amounts of data.
+")
+
 (set-procedure-property! cog-atom 'documentation
 "
  cog-atom UUID
@@ -0,0 +1,51 @@
+;
+; unordered-large.scm
+;
+; Unordered links with many members.  Trying every permutation of
+; these would take forever: a set of twelve has 479001600 of them.
+; Constants must be pinned to their groundings, and only the
+; variables permuted.
+
+(SetLink
+	(ConceptNode "a") (ConceptNode "b") (ConceptNode "c")
+	(ConceptNode "d") (ConceptNode "e") (ConceptNode "f")
+	(ConceptNode "g") (ConceptNode "h") (ConceptNode "i")
+	(ConceptNode "j")
+	(ListLink (ConceptNode "k") (ConceptNode "l"))
+	(PredicateNode "m")
+)
+
+;; One solution: $x is j, $y is m and $z is k.
+(define (large-set)
+	(BindLink
+		(VariableList
+			(TypedVariableLink (VariableNode "$x") (TypeNode "ConceptNode"))
+			(TypedVariableLink (VariableNode "$y") (TypeNode "PredicateNode"))
+			(TypedVariableLink (VariableNode "$z") (TypeNode "ConceptNode")))
+		(SetLink
+			(ConceptNode "a") (ConceptNode "b") (ConceptNode "c")
+			(ConceptNode "d") (ConceptNode "e") (ConceptNode "f")
+			(ConceptNode "g") (ConceptNode "h") (ConceptNode "i")
+			(VariableNode "$x")
+			(ListLink (VariableNode "$z") (ConceptNode "l"))
+			(VariableNode "$y"))
+		(ListLink (VariableNode "$x") (VariableNode "$y") (VariableNode "$z"))
+	)
+)
+
+;; Two solutions: $x and $y are i and j, either way around.
+(define (large-set-2)
+	(BindLink
+		(VariableList
+			(TypedVariableLink (VariableNode "$x") (TypeNode "ConceptNode"))
+			(TypedVariableLink (VariableNode "$y") (TypeNode "ConceptNode")))
+		(SetLink
+			(ConceptNode "a") (ConceptNode "b") (ConceptNode "c")
+			(ConceptNode "d") (ConceptNode "e") (ConceptNode "f")
+			(ConceptNode "g") (ConceptNode "h")
+			(VariableNode "$x") (VariableNode "$y")
+			(ListLink (ConceptNode "k") (ConceptNode "l"))
+			(PredicateNode "m"))
+		(ListLink (VariableNode "$x") (VariableNode "$y"))
+	)
+)
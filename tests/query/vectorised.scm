@@ -0,0 +1,77 @@
+;
+; vectorised.scm
+;
+; Two disconnected components, tied together by a virtual link
+; whose predicate is vectorised: it is handed the candidate groundings
+; in batches, rather than one at a time.
+;
+(use-modules (opencog))
+(use-modules (opencog exec))
+
+(MemberLink (NumberNode 1) (ConceptNode "left"))
+(MemberLink (NumberNode 2) (ConceptNode "left"))
+(MemberLink (NumberNode 3) (ConceptNode "left"))
+
+(MemberLink (NumberNode 1) (ConceptNode "right"))
+(MemberLink (NumberNode 2) (ConceptNode "right"))
+(MemberLink (NumberNode 3) (ConceptNode "right"))
+(MemberLink (NumberNode 4) (ConceptNode "right"))
+
+(define (num x) (string->number (cog-name x)))
+(define (greater? a b) (if (> (num a) (num b)) (stv 1 1) (stv 0 1)))
+
+; Count the calls, and the number of comparisons made.
+(define bigger-calls 0)
+(define bigger-items 0)
+
+; Vectorised: the arguments are lists, and a list of TV's is returned.
+(define (vec-bigger as bs)
+	(set! bigger-calls (+ 1 bigger-calls))
+	(set! bigger-items (+ (length as) bigger-items))
+	(map greater? as bs))
+
+; Vectorised, with a single argument that is not a ListLink: it is
+; handed a list of the pairs.
+(define (vec-bigger-pair ps)
+	(set! bigger-calls (+ 1 bigger-calls))
+	(set! bigger-items (+ (length ps) bigger-items))
+	(map (lambda (p) (greater? (gar p) (gdr p))) ps))
+
+; Ordinary: called once per candidate.
+(define (bigger a b)
+	(set! bigger-calls (+ 1 bigger-calls))
+	(set! bigger-items (+ 1 bigger-items))
+	(greater? a b))
+
+(define (reset-counts)
+	(set! bigger-calls 0)
+	(set! bigger-items 0))
+
+(define (bigger-query gpn)
+	(BindLink
+		(VariableList
+			(VariableNode "$a")
+			(VariableNode "$b"))
+		(AndLink
+			(MemberLink (VariableNode "$a") (ConceptNode "left"))
+			(MemberLink (VariableNode "$b") (ConceptNode "right"))
+			(EvaluationLink
+				(GroundedPredicateNode gpn)
+				(ListLink (VariableNode "$a") (VariableNode "$b"))))
+		(ListLink (VariableNode "$a") (VariableNode "$b"))))
+
+(define vec-query (bigger-query "scm-vec:vec-bigger"))
+(define plain-query (bigger-query "scm:bigger"))
+
+(define pair-query
+	(BindLink
+		(VariableList
+			(VariableNode "$a")
+			(VariableNode "$b"))
+		(AndLink
+			(MemberLink (VariableNode "$a") (ConceptNode "left"))
+			(MemberLink (VariableNode "$b") (ConceptNode "right"))
+			(EvaluationLink
+				(GroundedPredicateNode "scm-vec:vec-bigger-pair")
+				(InheritanceLink (VariableNode "$a") (VariableNode "$b"))))
+		(ListLink (VariableNode "$a") (VariableNode "$b"))))
@@ -0,0 +1,9 @@
+;
+; A module exporting a predicate, for the SCMExecutionOutputUTest test
+; of a local definition that hides an imported one.
+
+(define-module (tests scm shadow-test)
+	#:use-module (opencog)
+	#:export (shadow-pred))
+
+(define (shadow-pred x) (cog-new-stv 1 1))